@@ -4,13 +4,33 @@
 // Created by Yannic Lieder on 06.08.20.
 //
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
 #include <vector>
 
 #include <boost/program_options.hpp>
 
+#include "benchmark_journal.h"
 #include "get_time_str.h"
+#include "instance_pack.h"
+#include "parallel/cancellation_token.h"
+#include "parallel/work_stealing_pool.h"
+#include "upper_bound/pattern_order.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
+#include "upper_bound/solver_statistics.h"
 #include "upper_bound/upper_bound_solver.h"
 #include "serialization.h"
 
@@ -22,94 +42,549 @@ std::string hline() {
     return std::string(80, '*');
 }
 
-void run_benchmark(std::string const & input_dir, std::string const & instance_set, std::string const & output_dir,
-        bool visualize, int max_size) {
+/**
+ * JSON lines file with one record per instance, see write_record.
+ */
+struct RecordFile {
+    std::ofstream stream;
+    std::mutex mutex;
+};
+
+/**
+ * Command line options. The patterns and their order are derived from the pattern names and profile in main.
+ */
+struct Options {
+    bool visualize = false;
+    std::string output_dir = "out";
+    std::string base_dir;
+    std::vector<std::string> instance_sets;
+    int max_size = 0;
+    unsigned int jobs = 1;
+    unsigned int threads = 1;
+    bool subpolygon_tasks = false;
+    std::string profile_file;
+    std::string pattern_names;
+    std::string pattern_profile;
+    std::string shard;
+    std::string journal_file;
+    std::string records_file;
+    double time_limit = 0;
+    double total_time_limit = 0;
+
+    std::vector<Pattern> patterns;
+    std::shared_ptr<PatternOrder const> pattern_order;
+    std::size_t shard_index = 0;
+    std::size_t shard_count = 1;
+    std::shared_ptr<BenchmarkJournal> journal;
+    std::shared_ptr<RecordFile> records;
+    CancellationToken::Clock::time_point total_deadline;
+};
+
+/**
+ * An instance file or an instance of a pack, named by its path relative to the base directory.
+ */
+struct Instance {
+    fs::path path;
+    fs::path name;
+    std::size_t size;
+    std::size_t index; // Position in the instance set, before it is split into shards
+    InstancePack const * pack = nullptr;
+    std::size_t pack_index = 0;
+};
+
+/**
+ * Results and solver counters of an instance set, accumulated over all its instances.
+ */
+struct SetProfile {
+    std::string instance_set;
+    std::vector<Pattern> patterns;
+    int solved = 0;
+    int unsolved = 0;
+    int timeouts = 0;
+    double seconds = 0;
+    std::uint64_t angle_evaluations = 0;
+    std::uint64_t angle_exact_evaluations = 0;
+    SolverStatistics statistics;          // Solves with the pattern order of the options
+    SolverStatistics fallback_statistics; // Fallback solves with the fixed order (see --pattern_profile)
+    std::atomic<int> fallbacks{0};
+};
+
+/**
+ * Collects all instance files of the directory in iteration order. Instances larger than max_size are skipped.
+ */
+std::vector<Instance> collect_instances(std::string const & directory, std::string const & input_dir, int max_size) {
+    std::vector<Instance> instances;
+
+    using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
+    for (const auto & file : recursive_directory_iterator(directory)) {
+        if (!fs::is_regular_file(file) || file.path().extension() != ".pol") {
+            // Skip directories
+            continue;
+        }
+
+        std::size_t size = serialization::read_size(file);
+        if (max_size > 0 && size > (std::size_t)max_size) {
+            continue;
+        }
+        instances.push_back(Instance{file.path(), fs::relative(file.path(), fs::path(input_dir)), size,
+                instances.size()});
+    }
+    return instances;
+}
+
+/**
+ * Collects all instances of the pack in their order. The instances are only read when they are solved.
+ */
+std::vector<Instance> collect_instances(InstancePack const & pack, std::string const & input_dir, int max_size) {
+    std::vector<Instance> instances;
+    for (std::size_t i = 0; i < pack.size(); ++i) {
+        std::size_t size = pack.polygon_size(i);
+        if (max_size > 0 && size > (std::size_t)max_size) {
+            continue;
+        }
+        fs::path name(pack.name(i));
+        instances.push_back(Instance{fs::path(input_dir) / name, name, size, instances.size(), &pack, i});
+    }
+    return instances;
+}
+
+std::string json_string(std::string const & value) {
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+void print_counts(int n_solved, int n_unsolved, int n_timeouts) {
+    std::cout << "Solved: " << n_solved << std::endl;
+    std::cout << "Unsolved: " << n_unsolved << std::endl;
+    if (n_timeouts > 0) {
+        std::cout << "Timeout: " << n_timeouts << std::endl;
+    }
+    std::cout << "Total: " << (n_solved + n_unsolved + n_timeouts) << std::endl;
+}
+
+void print_instances(std::string const & title, std::vector<std::string> const & instances) {
+    if (!instances.empty()) {
+        std::cout << title << std::endl;
+        for (auto const &instance: instances) {
+            std::cout << "\t" << instance << std::endl;
+        }
+    }
+}
+
+Outcome solve_instance(Instance const & instance, Options const & options, SetProfile & profile, SolveTrace & trace) {
+    auto polygon = instance.pack
+            ? instance.pack->polygon<Kernel>(instance.pack_index)
+            : serialization::read_file<Kernel>(instance.path);
+
+    std::string rel_dir = fs::path(instance.name).remove_filename();
+    std::string filename = instance.name.stem();
+
+    UpperBoundSolver solver = UpperBoundSolver(polygon, options.patterns);
+    solver.set_visualize(options.visualize);
+    solver.set_output(options.output_dir, filename, rel_dir);
+    solver.set_threads(options.threads);
+    solver.set_subpolygon_tasks(options.subpolygon_tasks);
+    solver.set_pattern_order(options.pattern_order);
+
+    // The deadline of the instance is the earlier one of its own and the one of the whole run
+    using Clock = CancellationToken::Clock;
+    if (options.time_limit > 0 || options.total_time_limit > 0) {
+        Clock::time_point deadline = options.total_time_limit > 0 ? options.total_deadline : Clock::time_point::max();
+        if (options.time_limit > 0) {
+            deadline = std::min(deadline, Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(options.time_limit)));
+        }
+        solver.set_cancellation(std::make_shared<CancellationToken>(deadline));
+    }
+
+    std::pair<bool, Polygon> result =  solver.solve();
+    profile.statistics.add(solver.statistics());
+    trace = solver.trace();
+    if (trace.fallback) {
+        profile.fallback_statistics.add(solver.fallback_statistics());
+        ++profile.fallbacks;
+    }
+    if (std::get<0>(result)) {
+        return Outcome::SOLVED;
+    }
+    return trace.last().timed_out ? Outcome::TIMEOUT : Outcome::UNSOLVED;
+}
+
+/**
+ * Writes the course of a solve as JSON members.
+ */
+void write_trace(std::ostream & line, SolveTrace const & trace) {
+    line << "\"solve_seconds\": " << trace.seconds << ", "
+         << "\"splits\": " << trace.patterns.size() << ", "
+         << "\"max_depth\": " << trace.max_depth << ", "
+         << "\"unsolved_size\": " << trace.unsolved_size << ", "
+         << "\"remaining_polygons\": " << trace.remaining_polygons << ", "
+         << "\"patterns\": [";
+    for (std::size_t i = 0; i < trace.patterns.size(); ++i) {
+        line << (i > 0 ? ", " : "") << json_string(PatternManager::name((Pattern)trace.patterns[i]));
+    }
+    line << "]";
+}
+
+/**
+ * Writes the record of an instance (with any outcome) as a single line of JSON, which is flushed immediately.
+ */
+void write_record(RecordFile & records, std::string const & instance_set, Instance const & instance, Outcome outcome,
+        double seconds, SolveTrace const & trace) {
+    std::ostringstream line;
+    line << "{\"instance_set\": " << json_string(instance_set) << ", "
+         << "\"instance\": " << json_string(instance.name.generic_string()) << ", "
+         << "\"vertices\": " << trace.input.size << ", "
+         << "\"reflex_vertices\": " << trace.input.reflex_vertices << ", "
+         << "\"orthogonal\": " << (trace.input.orthogonal ? "true" : "false") << ", "
+         << "\"outcome\": " << json_string(outcome_name(outcome)) << ", "
+         << "\"seconds\": " << seconds << ", ";
+    write_trace(line, trace);
+    line << ", \"fallback\": ";
+    if (trace.fallback) {
+        line << "{";
+        write_trace(line, *trace.fallback);
+        line << "}";
+    } else {
+        line << "null";
+    }
+    line << "}";
+
+    std::lock_guard<std::mutex> lock(records.mutex);
+    records.stream << line.str() << std::endl;
+}
+
+void run_benchmark(Options const & options, std::string const & instance_set, SetProfile & profile) {
+    std::string const & input_dir = options.base_dir;
     std::string directory = input_dir + "/" + instance_set;
+    profile.instance_set = instance_set;
 
     std::cout << hline() << std::endl;
     std::cout << "BENCHMARK " << instance_set << std::endl;
     std::cout << "Input directory: " << input_dir << std::endl;
-    std::cout << "Output directory: " << output_dir << std::endl;
+    std::cout << "Output directory: " << options.output_dir << std::endl;
     std::cout << "Start time: " << get_time_str("%Y-%m-%d %H:%M:%S") << std::endl;
     std::cout << hline() << std::endl;
 
-    std::vector<Pattern> patterns = {
-            Pattern::SMALL_TRIANGLE,
-            Pattern::RADIUS,
-            Pattern::DUCT,
-            Pattern::HISTOGRAM,
-            Pattern::NON_CONVEX_VERTEX,
-            Pattern::CONVEX_SUBPOLYGON,
-            Pattern::EDGE_EXTENSION,
-    };
-
     int n_solved = 0;
     int n_unsolved = 0;
+    int n_timeouts = 0;
     std::vector<std::string> unsolved;
+    std::vector<std::string> timed_out;
+    auto start = std::chrono::steady_clock::now();
+
+    auto & angle_statistics = helpers::angle_predicate_statistics();
+    std::uint64_t angle_evaluations = angle_statistics.evaluations;
+    std::uint64_t angle_exact_evaluations = angle_statistics.exact_evaluations;
 
-    if (!fs::is_directory(directory)) {
-        std::cerr << "Not a directory: " << directory << std::endl;
+    // An instance set is either a directory or a pack file
+    std::unique_ptr<InstancePack> pack;
+    std::vector<Instance> instances;
+    if (fs::is_regular_file(directory) && InstancePack::is_pack(directory)) {
+        pack = std::make_unique<InstancePack>(directory);
+        instances = collect_instances(*pack, input_dir, options.max_size);
+    } else if (fs::is_directory(directory)) {
+        instances = collect_instances(directory, input_dir, options.max_size);
+    } else {
+        std::cerr << "Not a directory or instance pack: " << directory << std::endl;
         return;
     }
 
-    int i = 0;
-    using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
-    for (const auto & file : recursive_directory_iterator(directory)) {
-        if (!fs::is_regular_file(file) || file.path().extension() != ".pol") {
-            // Skip directories
-            continue;
-        }
+    // Every shard solves the instances, whose hashed name is its index modulo the number of shards
+    if (options.shard_count > 1) {
+        instances.erase(std::remove_if(instances.begin(), instances.end(), [&options](Instance const & instance) {
+            return instance_hash(instance.name.generic_string()) % options.shard_count != options.shard_index;
+        }), instances.end());
+        std::cout << "Shard " << (options.shard_index + 1) << "/" << options.shard_count << ": " << instances.size()
+                  << " instances" << std::endl;
+    }
 
-        auto polygon = serialization::read_file<Kernel>(file);
+    // Instances with a result in the journal of an earlier run are not solved again, except for timed out ones
+    std::vector<JournalRecord const *> journaled(instances.size(), nullptr);
+    if (options.journal) {
+        for (std::size_t i = 0; i < instances.size(); ++i) {
+            JournalRecord const * record = options.journal->find(instance_set, instances[i].name.generic_string());
+            journaled[i] = record && record->outcome != Outcome::TIMEOUT ? record : nullptr;
+        }
+    }
 
-        if (max_size > 0 && polygon.size() > max_size) {
-            continue;
+    auto solve = [&](std::size_t i) {
+        auto instance_start = std::chrono::steady_clock::now();
+        SolveTrace trace;
+        Outcome result = solve_instance(instances[i], options, profile, trace);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - instance_start).count();
+        if (options.journal) {
+            options.journal->append(JournalRecord{instance_set, instances[i].name.generic_string(), result, seconds,
+                    instances[i].index});
+        }
+        if (options.records) {
+            write_record(*options.records, instance_set, instances[i], result, seconds, trace);
         }
+        return result;
+    };
 
-        fs::path rel_path = fs::relative(file.path(), fs::path(input_dir));
-        std::string rel_dir = fs::path(rel_path).remove_filename();
-        std::string filename = fs::path(rel_path).stem();
+    auto print_result = [&](std::size_t i, Outcome outcome) {
+        if (journaled[i]) {
+            std::cout << " (journal)";
+        }
+        std::cout << " -> " << outcome_name(outcome) << std::endl;
+        if (outcome == Outcome::SOLVED) {
+            ++n_solved;
+        } else if (outcome == Outcome::UNSOLVED) {
+            ++n_unsolved;
+            unsolved.push_back(instances[i].name);
+        } else {
+            ++n_timeouts;
+            timed_out.push_back(instances[i].name);
+        }
+    };
 
-        std::cout << i++ << ". " << rel_path << std::flush;
+    if (options.jobs <= 1) {
+        for (std::size_t i = 0; i < instances.size(); ++i) {
+            std::cout << i << ". " << instances[i].name << std::flush;
+            print_result(i, journaled[i] ? journaled[i]->outcome : solve(i));
+        }
+    } else {
+        // Start with the largest instances, such that no large instance is solved alone at the end. The results are
+        // printed in the original instance order, as soon as all preceding instances are finished.
+        std::vector<std::size_t> schedule(instances.size());
+        std::iota(schedule.begin(), schedule.end(), 0);
+        std::stable_sort(schedule.begin(), schedule.end(), [&instances](std::size_t a, std::size_t b) {
+            return instances[a].size > instances[b].size;
+        });
 
-        UpperBoundSolver solver = UpperBoundSolver(polygon, patterns);
-        solver.set_visualize(visualize);
-        solver.set_output(output_dir, filename, rel_dir);
+        // An exception of an instance is rethrown, when its result would be printed, like in the serial run. Instances
+        // after the first failed instance (in the original order) are not printed and thus not solved anymore.
+        std::vector<char> finished(instances.size(), false);
+        std::vector<Outcome> outcomes(instances.size(), Outcome::UNSOLVED);
+        std::vector<std::exception_ptr> errors(instances.size());
+        std::size_t first_failed = instances.size();
+        std::mutex result_mutex;
+        std::condition_variable result_available;
 
-        std::pair<bool, Polygon> result =  solver.solve();
+        WorkStealingPool pool(options.jobs);
+        for (std::size_t i : schedule) {
+            if (journaled[i]) {
+                outcomes[i] = journaled[i]->outcome;
+                finished[i] = true;
+                continue;
+            }
+            pool.submit([&, i] {
+                Outcome result = Outcome::UNSOLVED;
+                std::exception_ptr error;
+                bool skipped;
+                {
+                    std::lock_guard<std::mutex> lock(result_mutex);
+                    skipped = i > first_failed;
+                }
+                if (!skipped) {
+                    try {
+                        result = solve(i);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(result_mutex);
+                    if (error) {
+                        first_failed = std::min(first_failed, i);
+                    }
+                    outcomes[i] = result;
+                    errors[i] = error;
+                    finished[i] = true;
+                }
+                result_available.notify_all();
+            });
+        }
 
-        if (std::get<0>(result)) {
-            ++n_solved;
-            std::cout << " -> solved" << std::endl;
-        } else {
-            ++n_unsolved;
-            std::cout << " -> unsolved" << std::endl;
-            unsolved.push_back(rel_path);
+        for (std::size_t i = 0; i < instances.size(); ++i) {
+            {
+                std::unique_lock<std::mutex> lock(result_mutex);
+                result_available.wait(lock, [&finished, i] { return finished[i]; });
+            }
+            std::cout << i << ". " << instances[i].name << std::flush;
+            if (errors[i]) {
+                std::rethrow_exception(errors[i]);
+            }
+            print_result(i, outcomes[i]);
         }
+        pool.wait();
     }
 
     std::cout << hline() << std::endl;
     std::cout << "FINISH BENCHMARK " << instance_set << std::endl;
     std::cout << "End time: " << get_time_str("%Y-%m-%d %H:%M:%S") << std::endl;
-    std::cout << "Solved: " << n_solved << std::endl;
-    std::cout << "Unsolved: " << n_unsolved << std::endl;
-    std::cout << "Total: " << (n_solved + n_unsolved) << std::endl;
-    if (n_unsolved > 0) {
-        std::cout << "Unsolved instances:" << std::endl;
-        for (auto const &instance: unsolved) {
-            std::cout << "\t" << instance << std::endl;
-        }
+    print_counts(n_solved, n_unsolved, n_timeouts);
+    angle_evaluations = angle_statistics.evaluations - angle_evaluations;
+    angle_exact_evaluations = angle_statistics.exact_evaluations - angle_exact_evaluations;
+    std::cout << "Angle predicates: " << angle_evaluations << " (exact fallback: " << angle_exact_evaluations;
+    if (angle_evaluations > 0) {
+        std::cout << ", " << 100.0 * angle_exact_evaluations / angle_evaluations << "%";
     }
+    std::cout << ")" << std::endl;
+
+    profile.patterns = options.patterns;
+    profile.solved = n_solved;
+    profile.unsolved = n_unsolved;
+    profile.timeouts = n_timeouts;
+    profile.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    profile.angle_evaluations = angle_evaluations;
+    profile.angle_exact_evaluations = angle_exact_evaluations;
+
+    print_instances("Unsolved instances:", unsolved);
+    print_instances("Timed out instances:", timed_out);
     std::cout << hline() << std::endl;
 }
 
-struct Options {
-    bool visualize = false;
-    std::string output_dir = "out";
-    std::string base_dir;
+/**
+ * Combines the journals of shards or resumed runs into the summary, which the benchmark prints per instance set. An
+ * instance in multiple journals counts once with its last result. The instances are listed in the order of the instance
+ * set, like in a single run without shards.
+ */
+int merge_journals(std::vector<std::string> const & journals) {
     std::vector<std::string> instance_sets;
-    int max_size = 0;
-};
+    std::map<std::string, std::map<std::string, JournalRecord>> results;
+    for (auto const & journal : journals) {
+        if (!fs::is_regular_file(journal)) {
+            std::cerr << "Not a file: " << journal << std::endl;
+            return 1;
+        }
+        for (JournalRecord const & record : BenchmarkJournal::read(journal)) {
+            if (results.find(record.instance_set) == results.end()) {
+                instance_sets.push_back(record.instance_set);
+            }
+            results[record.instance_set][record.instance] = record;
+        }
+    }
+
+    for (auto const & instance_set : instance_sets) {
+        int n_solved = 0;
+        int n_unsolved = 0;
+        int n_timeouts = 0;
+        double seconds = 0;
+        std::vector<std::string> unsolved;
+        std::vector<std::string> timed_out;
+
+        std::vector<JournalRecord const *> records;
+        for (auto const & entry : results[instance_set]) {
+            records.push_back(&entry.second);
+        }
+        std::stable_sort(records.begin(), records.end(), [](JournalRecord const * a, JournalRecord const * b) {
+            return a->index < b->index;
+        });
+
+        for (JournalRecord const * record : records) {
+            seconds += record->seconds;
+            if (record->outcome == Outcome::SOLVED) {
+                ++n_solved;
+            } else if (record->outcome == Outcome::UNSOLVED) {
+                ++n_unsolved;
+                unsolved.push_back(record->instance);
+            } else {
+                ++n_timeouts;
+                timed_out.push_back(record->instance);
+            }
+        }
+
+        std::cout << hline() << std::endl;
+        std::cout << "MERGED BENCHMARK " << instance_set << std::endl;
+        std::cout << "Journals: " << journals.size() << std::endl;
+        print_counts(n_solved, n_unsolved, n_timeouts);
+        std::cout << "Solve time: " << seconds << " s" << std::endl;
+        print_instances("Unsolved instances:", unsolved);
+        print_instances("Timed out instances:", timed_out);
+        std::cout << hline() << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * Writes a JSON array of the counters of the patterns (indexed by pattern value), in the given pattern order.
+ */
+void write_pattern_counters(std::ostream & out, std::vector<Pattern> const & patterns,
+        std::array<PatternStatistics, SolverStatistics::MAX_PATTERNS> const & counters, std::string const & indent) {
+    out << "[";
+    for (std::size_t j = 0; j < patterns.size(); ++j) {
+        BasePattern * pattern = PatternManager::get(patterns[j]);
+        PatternStatistics const & pattern_counters = counters[pattern->value()];
+        out << (j > 0 ? "," : "") << "\n" << indent << "  {"
+            << "\"name\": " << json_string(PatternManager::name(patterns[j])) << ", "
+            << "\"pattern\": " << json_string(pattern->description()) << ", "
+            << "\"calls\": " << pattern_counters.calls << ", "
+            << "\"successes\": " << pattern_counters.successes << ", "
+            << "\"candidates\": " << pattern_counters.candidates << ", "
+            << "\"segment_tests\": " << pattern_counters.segment_tests << ", "
+            << "\"milliseconds\": " << pattern_counters.nanoseconds / 1e6 << "}";
+    }
+    out << "\n" << indent << "]";
+}
+
+/**
+ * Writes the profiles as a JSON object with one member per instance set. The pattern counters are listed in the order
+ * of the pattern option, in total and per polygon class (see PolygonFeatures), which can be passed to the pattern
+ * profile option.
+ */
+void write_profiles(std::string const & filename, std::vector<std::unique_ptr<SetProfile>> const & profiles) {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Cannot write profile: " << filename << std::endl;
+        return;
+    }
+
+    out << "{";
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        SetProfile const & profile = *profiles[i];
+        SolverStatistics const & statistics = profile.statistics;
+        out << (i > 0 ? "," : "") << "\n  " << json_string(profile.instance_set) << ": {\n"
+            << "    \"instances\": " << (profile.solved + profile.unsolved + profile.timeouts) << ",\n"
+            << "    \"solved\": " << profile.solved << ",\n"
+            << "    \"unsolved\": " << profile.unsolved << ",\n"
+            << "    \"timeouts\": " << profile.timeouts << ",\n"
+            << "    \"seconds\": " << profile.seconds << ",\n"
+            << "    \"polygons\": " << statistics.polygons << ",\n"
+            << "    \"base_cases\": " << statistics.base_cases << ",\n"
+            << "    \"max_depth\": " << statistics.max_depth << ",\n"
+            << "    \"angle_predicates\": " << profile.angle_evaluations << ",\n"
+            << "    \"angle_predicates_exact\": " << profile.angle_exact_evaluations << ",\n"
+            << "    \"patterns\": ";
+        write_pattern_counters(out, profile.patterns, statistics.patterns, "    ");
+        out << ",\n    \"classes\": {";
+
+        bool first_class = true;
+        for (std::size_t c = 0; c < PolygonFeatures::CLASSES; ++c) {
+            auto const & counters = statistics.class_patterns[c];
+            bool used = std::any_of(counters.begin(), counters.end(), [](PatternStatistics const & pattern) {
+                return pattern.calls > 0;
+            });
+            if (!used) {
+                continue;
+            }
+            out << (first_class ? "" : ",") << "\n      \"" << c << "\": {\n"
+                << "        \"description\": " << json_string(PolygonFeatures::class_description(c)) << ",\n"
+                << "        \"patterns\": ";
+            write_pattern_counters(out, profile.patterns, counters, "        ");
+            out << "\n      }";
+            first_class = false;
+        }
+
+        // Not part of the counters above, such that they describe the pattern order of the run alone
+        SolverStatistics const & fallback = profile.fallback_statistics;
+        out << "\n    },\n    \"fallback\": {\n"
+            << "      \"instances\": " << profile.fallbacks << ",\n"
+            << "      \"polygons\": " << fallback.polygons << ",\n"
+            << "      \"base_cases\": " << fallback.base_cases << ",\n"
+            << "      \"patterns\": ";
+        write_pattern_counters(out, profile.patterns, fallback.patterns, "      ");
+        out << "\n    }\n  }";
+    }
+    out << "\n}" << std::endl;
+}
 
 void parse_args(int argc, char* argv[], Options &ops) {
     po::options_description desc;
@@ -121,6 +596,28 @@ void parse_args(int argc, char* argv[], Options &ops) {
                     "The instance directory, relative to the base directory")
             ("max_size,m", po::value<int>(&ops.max_size),
                     "Consider only instances with a size less than or equal to max size")
+            ("jobs,j", po::value<unsigned int>(&ops.jobs),
+                    "Number of instances solved in parallel")
+            ("threads,t", po::value<unsigned int>(&ops.threads),
+                    "Number of threads per instance, which test the split candidates of a pattern in parallel")
+            ("subpolygon_tasks,s", po::bool_switch(&ops.subpolygon_tasks),
+                    "Solve the subpolygons as parallel tasks on the threads of an instance instead")
+            ("profile,p", po::value<std::string>(&ops.profile_file),
+                    "Write the solver counters per instance set and pattern as JSON to the given file")
+            ("pattern_order", po::value<std::string>(&ops.pattern_names),
+                    "Comma separated pattern names in the order, in which they are tested")
+            ("pattern_profile", po::value<std::string>(&ops.pattern_profile),
+                    "Order the patterns per polygon class by the counters in a profile written with -p")
+            ("shard", po::value<std::string>(&ops.shard),
+                    "Solve only the i-th of N parts of every instance set, given as i/N with 1 <= i <= N")
+            ("journal", po::value<std::string>(&ops.journal_file),
+                    "Append the result of every instance to the journal and skip the instances already in it")
+            ("time_limit", po::value<double>(&ops.time_limit),
+                    "Stop the solver of an instance after the given seconds and report the instance as timed out")
+            ("total_time_limit", po::value<double>(&ops.total_time_limit),
+                    "Stop all solvers after the given seconds since the start and report the rest as timed out")
+            ("records", po::value<std::string>(&ops.records_file),
+                    "Write a JSON record per instance (size, outcome, time, splits, applied patterns) to the file")
             ;
 
     po::positional_options_description pdesc;
@@ -132,12 +629,80 @@ void parse_args(int argc, char* argv[], Options &ops) {
     po::notify(vm);
 }
 
+/**
+ * Parses the shard option "i/N" into a zero based index.
+ * \throws std::invalid_argument if the option is invalid
+ */
+void parse_shard(Options & options) {
+    std::size_t slash = options.shard.find('/');
+    char const * begin = options.shard.data();
+    char const * end = begin + options.shard.size();
+    std::size_t index = 0;
+    auto result = std::from_chars(begin, begin + std::min(slash, options.shard.size()), index);
+    bool valid = slash != std::string::npos && result.ec == std::errc() && result.ptr == begin + slash;
+    if (valid) {
+        result = std::from_chars(begin + slash + 1, end, options.shard_count);
+        valid = result.ec == std::errc() && result.ptr == end && index >= 1 && index <= options.shard_count;
+    }
+    if (!valid) {
+        throw std::invalid_argument("Invalid shard " + options.shard + ", expected i/N with 1 <= i <= N");
+    }
+    options.shard_index = index - 1;
+}
+
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        return merge_journals(std::vector<std::string>(argv + 2, argv + argc));
+    }
+
     Options options;
     parse_args(argc, argv, options);
 
+    if (options.threads > 1 && !KERNEL_THREAD_SAFE) {
+        std::cerr << "Multiple threads per instance (-t) are only supported by benchmark_epeck" << std::endl;
+        return 1;
+    }
+
+    try {
+        if (options.max_size < 0) {
+            throw std::invalid_argument("Invalid max size " + std::to_string(options.max_size) + ", expected >= 0");
+        }
+        options.patterns = options.pattern_names.empty()
+                ? PatternManager::default_order()
+                : PatternManager::parse(options.pattern_names);
+        if (!options.pattern_profile.empty()) {
+            auto order = std::make_shared<PatternOrder>(options.patterns);
+            order->load_profile(options.pattern_profile);
+            options.pattern_order = order;
+        }
+        if (!options.shard.empty()) {
+            parse_shard(options);
+        }
+        if (!options.journal_file.empty()) {
+            options.journal = std::make_shared<BenchmarkJournal>(options.journal_file);
+        }
+        if (!options.records_file.empty()) {
+            options.records = std::make_shared<RecordFile>();
+            options.records->stream.open(options.records_file, std::ios::app);
+            if (!options.records->stream) {
+                throw std::runtime_error("Cannot open records file " + options.records_file);
+            }
+        }
+    } catch (std::exception const & e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    options.total_deadline = CancellationToken::Clock::now() + std::chrono::duration_cast<
+            CancellationToken::Clock::duration>(std::chrono::duration<double>(options.total_time_limit));
     options.output_dir += "/benchmark_" + get_time_str();
+    std::vector<std::unique_ptr<SetProfile>> profiles;
     for (auto const & set: options.instance_sets) {
-        run_benchmark(options.base_dir, set, options.output_dir, options.visualize, options.max_size);
+        profiles.push_back(std::make_unique<SetProfile>());
+        run_benchmark(options, set, *profiles.back());
+    }
+
+    if (!options.profile_file.empty()) {
+        write_profiles(options.profile_file, profiles);
     }
 }
@@ -16,5 +16,5 @@
 	-i AGPLIB/AGP2009a/agp2009a-orthorand \
 	-i AGPLIB/AGP2009a/agp2009a-rvk \
 	-i AGPLIB/AGP2009a/agp2009a-simplerand \
-	2>&1 | tee benchmark_all_result.txt
+	"$@" 2>&1 | tee benchmark_all_result.txt
 
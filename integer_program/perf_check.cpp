@@ -0,0 +1,70 @@
+//
+// Performance regression gate of the IP approximation against a stored baseline, see ../src/perf_check.h.
+//
+
+#include <boost/program_options.hpp>
+
+#include "utils/conversion_utils.h"
+
+#include "integer_program/aagp_approximation.h"
+#include "verify_solution.h"
+#include "serialization.h"
+#include "../src/perf_check.h"
+
+using Epeck = CGAL::Exact_predicates_exact_constructions_kernel;
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    perf_check::Options options;
+    options.baseline_file = "perf_baseline_ip.tsv";
+    options.max_size = 100;
+    int max_angle = 20;
+
+    po::options_description option_description("Allowed options");
+    perf_check::add_options(option_description, options);
+    option_description.add_options()
+            ("angle,a", po::value<int>(&max_angle), "Maximal floodlight angle in degree");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, option_description), vm);
+    po::notify(vm);
+
+    auto read_size = [](std::filesystem::path const &path)
+    {
+        std::ifstream stream(path);
+        std::size_t size = 0;
+        stream >> size;
+        return size;
+    };
+
+    // Single threaded and silent, such that the times are comparable and not dominated by the output
+    auto solve = [&](std::filesystem::path const &path)
+    {
+        auto polygon = AAGP::serialization::read_agplib_file<Epeck>(path.string());
+        AAGP::IPApproximation<Epeck> approximation_solver(polygon, utils::conversion::to_radians(max_angle), true);
+        approximation_solver.use_threading(false);
+        approximation_solver.set_silent(true);
+        try
+        {
+            approximation_solver.compute();
+        }
+        catch (std::logic_error &ex)
+        {
+            return Outcome::UNSOLVED;
+        }
+        return AAGP::verify_solution(polygon, approximation_solver.solution()).first ? Outcome::SOLVED
+                                                                                      : Outcome::UNSOLVED;
+    };
+
+    try
+    {
+        return perf_check::run(options, "IPApproximation " + std::to_string(max_angle) + " degree", read_size, solve);
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 2;
+    }
+}
@@ -13,9 +13,9 @@
 #include <boost/filesystem.hpp>
 
 #include <limits>
-#include <regex>
 
 #include "floodlight/floodlight.h"
+#include "../src/number_parser.h"
 
 namespace fs = boost::filesystem;
 using QKernel = CGAL::Simple_cartesian<CGAL::Quotient<CGAL::MP_Float>>;
@@ -31,39 +31,8 @@ namespace AAGP
                 throw std::invalid_argument("Not a file: " + file.string());
             }
 
-
-            fs::ifstream stream{file};
-            CGAL::Polygon_2<Kernel> polygon;
-
-            std::string line;
-            std::string first, second;
-
-            // skip first line
-            stream >> first;
-            int size = std::stoi(first);
-
-            const std::regex r("([0-9]*)/([0-9]*)");
-
-            while (stream >> first >> second)
-            {
-                std::smatch sm;
-                regex_search(first, sm, r);
-
-                typename Kernel::FT x_num = std::stoi(sm[1]);
-                typename Kernel::FT x_den = std::stoi(sm[2]);
-
-                regex_search(second, sm, r);
-                typename Kernel::FT y_num = std::stoi(sm[1]);
-                typename Kernel::FT y_den = std::stoi(sm[2]);
-
-                typename Kernel::FT x = x_num / x_den;
-                typename Kernel::FT y = y_num / y_den;
-
-                polygon.push_back(CGAL::Point_2<Kernel>(x, y));
-            }
-
-            assert(polygon.size() == size);
-            return polygon;
+            // Fractions are parsed exactly and without overflow by the parser of the upper bound solver
+            return ::serialization::read_polygon<Kernel>(file.string());
         }
 
         template<class Kernel>
@@ -6,24 +6,32 @@
 
 #include <filesystem>
 #include <iostream>
+#include <memory>
 
 #include <boost/program_options.hpp>
 #include <get_time_str.h>
 
 #include "cgal_helpers/random_polygon_generator.h"
 #include "serialization.h"
+#include "upper_bound/pattern_order.h"
 #include "upper_bound/upper_bound_solver.h"
 
 
 namespace po = boost::program_options;
 namespace fs = std::filesystem;
 
-bool parse_args(int argc, char* argv[], std::string & input_file, std::string & output_dir, int & random) {
+bool parse_args(int argc, char* argv[], std::string & input_file, std::string & output_dir, int & random,
+        std::string & pattern_names, std::string & pattern_profile, double & time_limit) {
     po::options_description desc;
     desc.add_options()
             ("output,o", po::value<std::string>(&output_dir), "Specify output directory")
             ("file,f", po::value<std::string>(&input_file), "Path to the instance file")
             ("random,r", po::value<int>(&random), "Create random polygon of specified size")
+            ("pattern_order", po::value<std::string>(&pattern_names),
+                    "Comma separated pattern names in the order, in which they are tested")
+            ("pattern_profile", po::value<std::string>(&pattern_profile),
+                    "Order the patterns per polygon class by the counters in a benchmark profile")
+            ("time_limit", po::value<double>(&time_limit), "Stop the solver after the given seconds")
     ;
 
     po::positional_options_description pdesc;
@@ -45,8 +53,11 @@ int main(int argc, char* argv[]) {
     std::string input_file;
     std::string output_dir = "out/aagp_" + get_time_str();
     int random_size = 0;
+    std::string pattern_names;
+    std::string pattern_profile;
+    double time_limit = 0;
 
-    if (!parse_args(argc, argv, input_file, output_dir, random_size)) {
+    if (!parse_args(argc, argv, input_file, output_dir, random_size, pattern_names, pattern_profile, time_limit)) {
         return 1;
     }
 
@@ -74,23 +85,35 @@ int main(int argc, char* argv[]) {
     std::cout << "Output directory: " << (output_dir + "/" + polygon_name) << std::endl;
     std::cout << "Polygon: " << polygon << std::endl;
 
-    std::vector<Pattern> patterns = {
-            Pattern::SMALL_TRIANGLE,
-            Pattern::RADIUS,
-            Pattern::DUCT,
-            Pattern::HISTOGRAM,
-            Pattern::NON_CONVEX_VERTEX,
-            Pattern::CONVEX_SUBPOLYGON,
-            Pattern::EDGE_EXTENSION
-    };
+    std::vector<Pattern> patterns;
+    std::shared_ptr<PatternOrder> pattern_order;
+    try {
+        patterns = pattern_names.empty() ? PatternManager::default_order() : PatternManager::parse(pattern_names);
+        if (!pattern_profile.empty()) {
+            pattern_order = std::make_shared<PatternOrder>(patterns);
+            pattern_order->load_profile(pattern_profile);
+        }
+    } catch (std::exception const & e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
     UpperBoundSolver solver = UpperBoundSolver(polygon, patterns);
     solver.set_output(output_dir, polygon_name);
     solver.set_visualize(true);
+    solver.set_pattern_order(pattern_order);
+    if (time_limit > 0) {
+        using Clock = CancellationToken::Clock;
+        solver.set_cancellation(std::make_shared<CancellationToken>(
+                Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(time_limit))));
+    }
 
     std::pair<bool, Polygon> result =  solver.solve();
+    SolveTrace const & trace = solver.trace().last();
     if (std::get<0>(result)) {
         std::cout << "Solved! " << std::endl;
+    } else if (trace.timed_out) {
+        std::cout << "Time limit reached, " << trace.remaining_polygons << " subpolygons left" << std::endl;
     } else {
         std::cout << "Unsolved! " << std::endl;
     }
@@ -0,0 +1,497 @@
+//
+// Measures the runtime and allocations of single building blocks of the solver on random, orthogonal and spiral
+// polygons of increasing size, or the throughput of the instance parser on an instance directory.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "allocation_counter.h"
+#include "cgal_helpers/angle.h"
+#include "cgal_helpers/edge_grid.h"
+#include "cgal_helpers/polygon_normalization.h"
+#include "cgal_helpers/random_polygon_generator.h"
+#include "kernel_definitions.h"
+#include "number_parser.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
+#include "upper_bound/patterns/helpers/cosine_30.h"
+#include "upper_bound/patterns/helpers/edge_extension_helpers.h"
+#include "upper_bound/patterns/helpers/segment_inside_polygon.h"
+#include "upper_bound/patterns/helpers/split_polygon.h"
+#include "upper_bound/upper_bound_solver.h"
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+using Clock = std::chrono::steady_clock;
+
+// Results of the measured operations are accumulated here, such that they cannot be optimized away
+static volatile std::size_t sink = 0;
+
+enum class Family {
+    RANDOM,
+    ORTHOGONAL,
+    SPIRAL
+};
+
+static char const * family_name(Family family) {
+    switch (family) {
+        case Family::RANDOM:
+            return "random";
+        case Family::ORTHOGONAL:
+            return "orthogonal";
+        default:
+            return "spiral";
+    }
+}
+
+struct Options {
+    std::vector<int> sizes;
+    std::vector<Family> families;
+    int instances = 5;
+    int queries = 32;
+    int seed = 0;
+    std::string parse_dir;
+};
+
+void parse_args(int argc, char* argv[], Options & ops) {
+    std::string str_sizes = "50,100,200,400,800";
+    std::string str_families = "random,orthogonal,spiral";
+
+    po::options_description desc;
+    desc.add_options()
+            ("sizes,r", po::value<std::string>(&str_sizes), "Comma separated list of polygon sizes")
+            ("families,f", po::value<std::string>(&str_families),
+                    "Comma separated list of polygon families (random, orthogonal, spiral)")
+            ("instances,n", po::value<int>(&ops.instances), "Number of random polygons per size")
+            ("queries,q", po::value<int>(&ops.queries), "Number of segment queries per polygon vertex")
+            ("seed,s", po::value<int>(&ops.seed), "Seed of the random polygon generator")
+            ("parse,p", po::value<std::string>(&ops.parse_dir),
+                    "Measure the parser on all instance files in the directory (e.g. AGPLIB) instead")
+            ;
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+    po::notify(vm);
+
+    typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
+    boost::char_separator<char> sep(",");
+    for (auto const & token : tokenizer(str_sizes, sep)) {
+        ops.sizes.push_back(std::stoi(token));
+    }
+    for (auto const & token : tokenizer(str_families, sep)) {
+        bool known = false;
+        for (Family family : {Family::RANDOM, Family::ORTHOGONAL, Family::SPIRAL}) {
+            if (token == family_name(family)) {
+                ops.families.push_back(family);
+                known = true;
+            }
+        }
+        if (!known) {
+            throw std::invalid_argument("Unknown polygon family: " + token);
+        }
+    }
+}
+
+double milliseconds_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Runtime and operator new calls per operation.
+ */
+struct Measurement {
+    double nanoseconds = 0;
+    double allocations = 0;
+};
+
+/**
+ * Runs all operations at once and averages the runtime and allocations.
+ */
+template <class Operations>
+Measurement measure(std::size_t n_operations, Operations && operations) {
+    std::uint64_t allocations_before = allocation_count();
+    auto start = Clock::now();
+    operations();
+    double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    double n_allocations = allocation_count() - allocations_before;
+    return Measurement{nanoseconds / std::max<std::size_t>(n_operations, 1),
+                       n_allocations / std::max<std::size_t>(n_operations, 1)};
+}
+
+void print_measurement(std::string const & name, Measurement const & measurement) {
+    std::cout << "  " << std::left << std::setw(36) << (name + ":") << std::right
+              << std::setw(14) << measurement.nanoseconds << " ns/op"
+              << std::setw(12) << measurement.allocations << " allocs/op" << std::endl;
+}
+
+Polygon generate(RandomPolygonGenerator<Kernel> & generator, Family family, int size) {
+    switch (family) {
+        case Family::RANDOM:
+            return generator.generate_star_shaped(size);
+        case Family::ORTHOGONAL:
+            return generator.generate_orthogonal(size);
+        default:
+            return generator.generate_spiral(size);
+    }
+}
+
+/**
+ * Segments between random pairs of polygon vertices, as tested by the patterns.
+ */
+std::vector<Segment> random_vertex_segments(Polygon const & polygon, int queries_per_vertex, std::mt19937 & gen) {
+    std::uniform_int_distribution<std::size_t> dis(0, polygon.size() - 1);
+    std::vector<Segment> segments;
+    for (std::size_t i = 0; i < polygon.size(); ++i) {
+        for (int k = 0; k < queries_per_vertex; ++k) {
+            std::size_t j = dis(gen);
+            if (j != i) {
+                segments.emplace_back(polygon[i], polygon[j]);
+            }
+        }
+    }
+    return segments;
+}
+
+/**
+ * Compares segment_inside_polygon with a full scan over all edges to the edge grid version.
+ */
+void benchmark_segment_inside_polygon(Options const & options, std::vector<Polygon> const & polygons,
+        std::mt19937 & gen) {
+    double scan_time = 0;
+    double grid_time = 0;
+    double build_time = 0;
+    std::uint64_t scan_allocations = 0;
+    std::uint64_t grid_allocations = 0;
+    std::size_t n_queries = 0;
+    std::size_t n_mismatches = 0;
+
+    for (auto const & polygon : polygons) {
+        auto segments = random_vertex_segments(polygon, options.queries, gen);
+        n_queries += segments.size();
+
+        std::vector<bool> scan_results;
+        scan_results.reserve(segments.size());
+        std::uint64_t allocations_before = allocation_count();
+        auto start = Clock::now();
+        for (auto const & segment : segments) {
+            scan_results.push_back(segment_inside_polygon(polygon, segment));
+        }
+        scan_time += milliseconds_since(start);
+        scan_allocations += allocation_count() - allocations_before;
+
+        start = Clock::now();
+        EdgeGrid<Kernel> grid(polygon);
+        build_time += milliseconds_since(start);
+
+        std::vector<bool> grid_results;
+        grid_results.reserve(segments.size());
+        allocations_before = allocation_count();
+        start = Clock::now();
+        for (auto const & segment : segments) {
+            grid_results.push_back(segment_inside_polygon(grid, segment));
+        }
+        grid_time += milliseconds_since(start);
+        grid_allocations += allocation_count() - allocations_before;
+
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            n_mismatches += scan_results[i] != grid_results[i];
+        }
+    }
+
+    print_measurement("segment_inside_polygon (scan)",
+            Measurement{1e6 * scan_time / n_queries, (double)scan_allocations / n_queries});
+    print_measurement("segment_inside_polygon (grid)",
+            Measurement{1e6 * grid_time / n_queries, (double)grid_allocations / n_queries});
+    std::cout << "    " << n_queries << " queries, grid build " << build_time / polygons.size() << " ms/polygon, "
+              << "speedup " << scan_time / grid_time;
+    if (n_mismatches > 0) {
+        std::cout << ", MISMATCHES: " << n_mismatches;
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * Random pairs of vertex indices, whose segment lies inside the polygon (the precondition of split_polygon), at most
+ * max_pairs per polygon.
+ */
+std::vector<std::pair<std::size_t, std::size_t>> random_diagonals(Polygon const & polygon, std::size_t max_pairs,
+        std::mt19937 & gen) {
+    EdgeGrid<Kernel> grid(polygon);
+    std::uniform_int_distribution<std::size_t> dis(0, polygon.size() - 1);
+    std::vector<std::pair<std::size_t, std::size_t>> diagonals;
+    for (std::size_t attempt = 0; attempt < 32 * max_pairs && diagonals.size() < max_pairs; ++attempt) {
+        std::size_t i = dis(gen);
+        std::size_t j = dis(gen);
+        std::size_t n = polygon.size();
+        if (i == j || (i + 1) % n == j || (j + 1) % n == i) {
+            continue;
+        }
+        if (segment_inside_polygon(grid, Segment(polygon[i], polygon[j]))) {
+            diagonals.emplace_back(i, j);
+        }
+    }
+    return diagonals;
+}
+
+/**
+ * The cosine itself requires a kernel with sqrt, with the Epeck kernel only the exact predicates without sqrt, which
+ * replace it in the patterns, are measured.
+ */
+template <class K>
+void benchmark_angles(std::vector<CGAL::Polygon_2<K>> const & polygons) {
+    std::size_t n_vertices = 0;
+    for (auto const & polygon : polygons) {
+        n_vertices += polygon.size();
+    }
+
+    using Category = typename CGAL::Algebraic_structure_traits<typename K::FT>::Algebraic_category;
+    if constexpr (!std::is_same_v<Category, CGAL::Field_tag>) {
+        print_measurement("Angle::cosine", measure(n_vertices, [&] {
+            for (auto const & polygon : polygons) {
+                auto start = polygon.vertices_circulator();
+                auto current = start;
+                do {
+                    sink = sink + (Angle<K>(current).cosine() > 0);
+                } while (++current != start);
+            }
+        }));
+        print_measurement("smallest_inner_angle_cos", measure(polygons.size(), [&] {
+            for (auto const & polygon : polygons) {
+                sink = sink + (smallest_inner_angle_cos(polygon) > 0);
+            }
+        }));
+    }
+
+    print_measurement("Angle::squared_cosine", measure(n_vertices, [&] {
+        for (auto const & polygon : polygons) {
+            auto start = polygon.vertices_circulator();
+            auto current = start;
+            do {
+                sink = sink + (Angle<K>(current).squared_cosine() > 0);
+            } while (++current != start);
+        }
+    }));
+    print_measurement("smallest_inner_angle_at_most_30", measure(2 * polygons.size(), [&] {
+        for (auto const & polygon : polygons) {
+            sink = sink + helpers::smallest_inner_angle_at_most_30(polygon, 1);
+            sink = sink + helpers::smallest_inner_angle_at_most_30(polygon, 2);
+        }
+    }));
+}
+
+/**
+ * Measures the helpers of the patterns on the polygons. Operations on single vertices or segments use up to the given
+ * number of random samples per polygon.
+ */
+void benchmark_helpers(std::vector<Polygon> const & polygons, std::size_t samples, std::mt19937 & gen) {
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> diagonals;
+    std::vector<std::vector<std::size_t>> vertices;
+    std::size_t n_diagonals = 0;
+    std::size_t n_samples = 0;
+    for (auto const & polygon : polygons) {
+        diagonals.push_back(random_diagonals(polygon, samples, gen));
+        n_diagonals += diagonals.back().size();
+
+        std::uniform_int_distribution<std::size_t> dis(0, polygon.size() - 1);
+        vertices.emplace_back();
+        for (std::size_t k = 0; k < samples; ++k) {
+            vertices.back().push_back(dis(gen));
+        }
+        n_samples += samples;
+    }
+
+    std::vector<std::unique_ptr<VertexPool>> pools;
+    for (auto const & polygon : polygons) {
+        pools.push_back(std::make_unique<VertexPool>(polygon));
+    }
+
+    print_measurement("split_polygon (points)", measure(n_diagonals, [&] {
+        for (std::size_t p = 0; p < polygons.size(); ++p) {
+            auto circulator = polygons[p].vertices_circulator();
+            for (auto const & [i, j] : diagonals[p]) {
+                auto result = split_polygon(polygons[p], circulator + i, circulator + j);
+                sink = sink + result.left.size() + result.right.size();
+            }
+        }
+    }));
+    print_measurement("split_polygon (vertex ids)", measure(n_diagonals, [&] {
+        for (std::size_t p = 0; p < polygons.size(); ++p) {
+            VertexIds ids(pools[p]->input_size());
+            std::iota(ids.begin(), ids.end(), 0);
+            for (auto const & [i, j] : diagonals[p]) {
+                auto result = split_polygon(*pools[p], ids, i, j);
+                sink = sink + result.left.size() + result.right.size();
+            }
+        }
+    }));
+    print_measurement("split_right_side (vertex ids)", measure(n_diagonals, [&] {
+        for (std::size_t p = 0; p < polygons.size(); ++p) {
+            VertexIds ids(pools[p]->input_size());
+            std::iota(ids.begin(), ids.end(), 0);
+            for (auto const & [i, j] : diagonals[p]) {
+                sink = sink + split_right_side(*pools[p], ids, i, j).size();
+            }
+        }
+    }));
+
+    print_measurement("is_normalized", measure(polygons.size(), [&] {
+        for (auto const & polygon : polygons) {
+            sink = sink + is_normalized(polygon);
+        }
+    }));
+    print_measurement("normalize_polygon", measure(polygons.size(), [&] {
+        for (auto const & polygon : polygons) {
+            sink = sink + normalize_polygon(polygon).size();
+        }
+    }));
+    print_measurement("normalize_polygon (vertex ids)", measure(polygons.size(), [&] {
+        for (auto const & pool : pools) {
+            VertexIds ids(pool->input_size());
+            std::iota(ids.begin(), ids.end(), 0);
+            sink = sink + normalize_polygon(*pool, ids).size();
+        }
+    }));
+
+    std::vector<std::unique_ptr<PolygonContext>> contexts;
+    for (auto const & pool : pools) {
+        VertexIds ids(pool->input_size());
+        std::iota(ids.begin(), ids.end(), 0);
+        contexts.push_back(std::make_unique<PolygonContext>(*pool, ids));
+        contexts.back()->build_indices();
+    }
+    print_measurement("first_boundary_hit", measure(n_samples, [&] {
+        for (std::size_t p = 0; p < polygons.size(); ++p) {
+            for (std::size_t i : vertices[p]) {
+                PolygonContext const & context = *contexts[p];
+                auto hit = helpers::first_boundary_hit(context, i, context.vertex(i) - context.vertex((long)i - 1));
+                sink = sink + hit.found;
+            }
+        }
+    }));
+
+    benchmark_angles(polygons);
+
+    constexpr std::size_t COSINE_30_REPETITIONS = 1000;
+    print_measurement("squared_cosine_30", measure(12 * COSINE_30_REPETITIONS, [&] {
+        for (std::size_t r = 0; r < COSINE_30_REPETITIONS; ++r) {
+            for (int k = 0; k < 12; ++k) {
+                sink = sink + (squared_cosine_30(k) > 0);
+            }
+        }
+    }));
+    print_measurement("cosine_30_interval", measure(12 * COSINE_30_REPETITIONS, [&] {
+        for (std::size_t r = 0; r < COSINE_30_REPETITIONS; ++r) {
+            for (int k = 0; k < 12; ++k) {
+                sink = sink + (cosine_30_interval(k).upper() > 0);
+            }
+        }
+    }));
+}
+
+void benchmark_solver(std::vector<Polygon> const & polygons) {
+    std::vector<Pattern> patterns = PatternManager::default_order();
+    int n_solved = 0;
+
+    auto start = Clock::now();
+    for (auto const & polygon : polygons) {
+        UpperBoundSolver solver(polygon, patterns);
+        n_solved += solver.solve().first;
+    }
+    double time = milliseconds_since(start);
+
+    std::cout << "  solver: " << time / polygons.size() << " ms/polygon, solved "
+              << n_solved << "/" << polygons.size() << std::endl;
+}
+
+/**
+ * Parses all instance files in the directory from memory, such that the file system is not measured. The whitespace
+ * tokenization of an input stream, which the parser replaced, is measured for comparison.
+ */
+void benchmark_parser(std::string const & directory) {
+    std::vector<std::string> texts;
+    std::size_t n_bytes = 0;
+    auto start = Clock::now();
+    for (auto const & file : fs::recursive_directory_iterator(directory)) {
+        if (fs::is_regular_file(file) && file.path().extension() == ".pol") {
+            texts.push_back(serialization::read_text(file.path().string()));
+            n_bytes += texts.back().size();
+        }
+    }
+    double read_time = milliseconds_since(start);
+    if (texts.empty()) {
+        std::cout << "No instance files in " << directory << std::endl;
+        return;
+    }
+
+    std::size_t n_tokens = 0;
+    start = Clock::now();
+    for (auto const & text : texts) {
+        std::istringstream stream(text);
+        std::string token;
+        while (stream >> token) {
+            ++n_tokens;
+        }
+    }
+    double stream_time = milliseconds_since(start);
+
+    std::size_t n_coordinates = 0;
+    start = Clock::now();
+    for (auto const & text : texts) {
+        n_coordinates += 2 * serialization::parse_polygon<Kernel>(text).size();
+    }
+    double parse_time = milliseconds_since(start);
+
+    double megabytes = n_bytes / 1e6;
+    std::cout << texts.size() << " instances, " << megabytes << " MB, " << n_coordinates << " coordinates" << std::endl;
+    std::cout << "  read: " << read_time << " ms" << std::endl;
+    std::cout << "  stream tokens only: " << stream_time << " ms, " << 1000 * megabytes / stream_time << " MB/s, "
+              << 1000 * (n_tokens - texts.size()) / stream_time << " coordinates/s" << std::endl;
+    std::cout << "  parse: " << parse_time << " ms, " << 1000 * megabytes / parse_time << " MB/s, "
+              << 1000 * n_coordinates / parse_time << " coordinates/s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    parse_args(argc, argv, options);
+
+    if (!options.parse_dir.empty()) {
+        std::cout << std::fixed << std::setprecision(3);
+        benchmark_parser(options.parse_dir);
+        return 0;
+    }
+
+    RandomPolygonGenerator<Kernel> generator(options.seed);
+    std::mt19937 gen(options.seed);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Seed: " << options.seed << std::endl;
+
+    for (Family family : options.families) {
+        for (int size : options.sizes) {
+            std::vector<Polygon> polygons;
+            for (int i = 0; i < options.instances; ++i) {
+                polygons.push_back(generate(generator, family, size));
+            }
+
+            std::cout << family_name(family) << " polygons of size " << size << " (" << polygons.size()
+                      << " polygons)" << std::endl;
+            benchmark_segment_inside_polygon(options, polygons, gen);
+            benchmark_helpers(polygons, 64, gen);
+            benchmark_solver(polygons);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+//
+// Converts instance sets into a single binary pack file, which can be passed to the benchmark instead of a directory.
+//
+
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "instance_pack.h"
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+struct Options {
+    std::string base_dir;
+    std::vector<std::string> instance_sets;
+    std::string output_file;
+};
+
+void parse_args(int argc, char* argv[], Options &ops) {
+    po::options_description desc;
+    desc.add_options()
+            ("base_dir,b", po::value<std::string>(&ops.base_dir), "Instance base directory")
+            ("instance_set,i", po::value<std::vector<std::string>>(&ops.instance_sets)->required(),
+                    "The instance directory, relative to the base directory")
+            ("output,o", po::value<std::string>(&ops.output_file)->required(), "The pack file to write")
+            ;
+
+    po::positional_options_description pdesc;
+    pdesc.add("instance_set", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+            options(desc).positional(pdesc).run(), vm);
+    po::notify(vm);
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    parse_args(argc, argv, options);
+
+    // The instances are named by their path relative to the base directory and stored in the order, in which the
+    // benchmark would solve the directories
+    InstancePackWriter writer;
+    for (auto const & set : options.instance_sets) {
+        fs::path directory = fs::path(options.base_dir) / set;
+        if (!fs::is_directory(directory)) {
+            std::cerr << "Not a directory: " << directory << std::endl;
+            return 1;
+        }
+
+        std::size_t n = writer.size();
+        for (auto const & file : fs::recursive_directory_iterator(directory)) {
+            if (!fs::is_regular_file(file) || file.path().extension() != ".pol") {
+                continue;
+            }
+            writer.add_file(file.path(), fs::relative(file.path(), fs::path(options.base_dir)));
+        }
+        std::cout << set << ": " << (writer.size() - n) << " instances" << std::endl;
+    }
+
+    writer.write(options.output_file);
+    std::cout << "Wrote " << writer.size() << " instances to " << options.output_file << std::endl;
+}
@@ -0,0 +1,11 @@
+# Records the baselines of the performance regression checks on the reference machine, with the default options
+# (seed 0). The IP check is skipped, if AAGP_PerfCheck (of the integer program) is not in the current directory.
+MACHINE="$(grep -m 1 'model name' /proc/cpuinfo | cut -d ':' -f 2 | sed 's/^ *//'), $(nproc) threads, $(uname -sr)"
+
+./perf_check -b resources/instances --update --baseline benchmark_results/perf_baseline.tsv \
+	--machine "$MACHINE" "$@" || exit 1
+
+if [ -x ./AAGP_PerfCheck ]; then
+	./AAGP_PerfCheck -b resources/instances --update --baseline benchmark_results/perf_baseline_ip.tsv \
+		--machine "$MACHINE" "$@" || exit 1
+fi
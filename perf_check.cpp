@@ -0,0 +1,46 @@
+//
+// Performance regression gate of the upper bound solver against a stored baseline, see perf_check.h.
+//
+
+#include <filesystem>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "perf_check.h"
+#include "serialization.h"
+#include "upper_bound/pattern_manager.h"
+#include "upper_bound/upper_bound_solver.h"
+
+
+namespace po = boost::program_options;
+namespace fs = std::filesystem;
+
+void parse_args(int argc, char* argv[], perf_check::Options & ops) {
+    po::options_description desc;
+    perf_check::add_options(desc, ops);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+    po::notify(vm);
+}
+
+int main(int argc, char* argv[]) {
+    perf_check::Options options;
+    options.baseline_file = "benchmark_results/perf_baseline.tsv";
+    parse_args(argc, argv, options);
+
+    // The solver runs single threaded with the default pattern order, such that the times are comparable
+    std::vector<Pattern> patterns = PatternManager::default_order();
+    auto solve = [&](fs::path const & path) {
+        UpperBoundSolver solver(serialization::read_file<Kernel>(path), patterns);
+        return solver.solve().first ? Outcome::SOLVED : Outcome::UNSOLVED;
+    };
+
+    try {
+        return perf_check::run(options, "UpperBoundSolver", serialization::read_size, solve);
+    } catch (std::exception const & e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
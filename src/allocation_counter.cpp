@@ -0,0 +1,44 @@
+//
+// Replacements of the global allocation functions, which count the allocations.
+//
+
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+static std::atomic<std::uint64_t> allocations{0};
+
+std::uint64_t allocation_count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void * operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void * pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void * pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void * pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
@@ -0,0 +1,20 @@
+//
+// Number of allocations by the global operator new, for the micro benchmark.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_ALLOCATION_COUNTER_H
+#define ANGULAR_ART_GALLERY_PROBLEM_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+
+/**
+ * Returns the number of calls of the global operator new (single object and array) since the start of the program.
+ * Number types with their own allocator (e.g. GMP numbers of the Epeck kernel) are not counted.
+ *
+ * Only available in targets, which link allocation_counter.cpp. It replaces the global allocation functions, which is
+ * done in a separate translation unit, such that the replacements are not inlined into the callers.
+ */
+std::uint64_t allocation_count();
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_ALLOCATION_COUNTER_H
@@ -0,0 +1,190 @@
+//
+// Append-only journal of the benchmark results per instance, which allows to resume and merge benchmark runs.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_BENCHMARK_JOURNAL_H
+#define ANGULAR_ART_GALLERY_PROBLEM_BENCHMARK_JOURNAL_H
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/**
+ * Result of an instance. A timed out instance was stopped by a time limit and may still be solvable.
+ */
+enum class Outcome {
+    SOLVED,
+    UNSOLVED,
+    TIMEOUT
+};
+
+static char const * outcome_name(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::SOLVED:
+            return "solved";
+        case Outcome::UNSOLVED:
+            return "unsolved";
+        default:
+            return "timeout";
+    }
+}
+
+struct JournalRecord {
+    // Index of records without one (written before the index was added), which are ordered after all others
+    static constexpr std::size_t NO_INDEX = SIZE_MAX;
+
+    std::string instance_set;
+    std::string instance;
+    Outcome outcome = Outcome::UNSOLVED;
+    double seconds = 0;
+    std::size_t index = NO_INDEX; // Position of the instance in its instance set
+};
+
+/**
+ * Every line of a journal is one record: instance set, instance name (relative to the base directory), outcome
+ * ("solved", "unsolved" or "timeout"), the solve time in seconds and the index of the instance in its set, separated by
+ * tabs. The index may be missing. A record is written and flushed
+ * as soon as its instance is finished, such that a crash loses at most the last, incomplete line, which is ignored when
+ * the journal is read.
+ */
+class BenchmarkJournal {
+public:
+    /**
+     * Opens the journal for appending and reads the records of earlier runs.
+     * \throws std::runtime_error if the journal cannot be opened
+     */
+    explicit BenchmarkJournal(std::string const & filename) : filename(filename) {
+        bool complete = true;
+        for (JournalRecord const & record : read(filename, &complete)) {
+            records[{record.instance_set, record.instance}] = record;
+        }
+
+        stream.open(filename, std::ios::app);
+        if (!stream) {
+            throw std::runtime_error("Cannot open journal " + filename);
+        }
+        if (!complete) {
+            // Terminate the incomplete line of a crashed run, such that it stays a single invalid line
+            stream << std::endl;
+        }
+    }
+
+    /**
+     * Returns the record of the instance from an earlier run, or nullptr if there is none.
+     */
+    JournalRecord const * find(std::string const & instance_set, std::string const & instance) const {
+        auto it = records.find({instance_set, instance});
+        return it != records.end() ? &it->second : nullptr;
+    }
+
+    /**
+     * Appends the record, may be called from multiple threads.
+     */
+    void append(JournalRecord const & record) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stream << record.instance_set << '\t' << record.instance << '\t' << outcome_name(record.outcome) << '\t'
+               << record.seconds << '\t' << record.index << std::endl;
+        if (!stream) {
+            throw std::runtime_error("Cannot write journal " + filename);
+        }
+    }
+
+    /**
+     * Reads all valid records of a journal in file order. complete is set to false, if the last line is not terminated.
+     * \throws std::runtime_error if the journal cannot be read
+     */
+    static std::vector<JournalRecord> read(std::string const & filename, bool * complete = nullptr) {
+        std::ifstream file(filename);
+        if (!file) {
+            if (complete) {
+                *complete = true;
+            }
+            return {};
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string text = buffer.str();
+        if (complete) {
+            *complete = text.empty() || text.back() == '\n';
+        }
+
+        std::vector<JournalRecord> result;
+        std::size_t begin = 0;
+        for (std::size_t end = text.find('\n'); end != std::string::npos; end = text.find('\n', begin)) {
+            JournalRecord record;
+            if (parse_line(text.substr(begin, end - begin), record)) {
+                result.push_back(record);
+            }
+            begin = end + 1;
+        }
+        return result;
+    }
+
+private:
+    std::string filename;
+    std::map<std::pair<std::string, std::string>, JournalRecord> records;
+    std::ofstream stream;
+    std::mutex mutex;
+
+    static bool parse_line(std::string const & line, JournalRecord & record) {
+        std::vector<std::string> fields;
+        std::size_t begin = 0;
+        for (std::size_t end = line.find('\t'); ; end = line.find('\t', begin)) {
+            fields.push_back(line.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+            if (end == std::string::npos) {
+                break;
+            }
+            begin = end + 1;
+        }
+        if (fields.size() != 4 && fields.size() != 5) {
+            return false;
+        }
+        bool known = false;
+        for (Outcome outcome : {Outcome::SOLVED, Outcome::UNSOLVED, Outcome::TIMEOUT}) {
+            if (fields[2] == outcome_name(outcome)) {
+                record.outcome = outcome;
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+
+        record.instance_set = fields[0];
+        record.instance = fields[1];
+        try {
+            record.seconds = std::stod(fields[3]);
+        } catch (std::logic_error const &) {
+            return false;
+        }
+        if (fields.size() == 5) {
+            auto result = std::from_chars(fields[4].data(), fields[4].data() + fields[4].size(), record.index);
+            if (result.ec != std::errc() || result.ptr != fields[4].data() + fields[4].size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * Stable hash of an instance name (64 bit FNV-1a), such that every machine assigns the instances to the same shards.
+ */
+static std::uint64_t instance_hash(std::string const & name) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_BENCHMARK_JOURNAL_H
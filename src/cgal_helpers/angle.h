@@ -1,6 +1,6 @@
 //
-// Defines an angle class. Exact angle comparisons are possible, if kernel with sqrt is used and online cosines are
-// compared.
+// Defines an angle class. Exact angle comparisons are possible by comparing squared cosines, which are rational, or
+// the cosines itself, if a kernel with sqrt is used.
 //
 // Created by Yannic Lieder on 02.08.20.
 //
@@ -38,14 +38,66 @@ public:
         return convex;
     }
 
+    /**
+     * Requires a kernel with sqrt.
+     */
     typename Kernel::FT cosine() const {
         CGAL::Vector_2<Kernel> v1 = p3 - p2;
         CGAL::Vector_2<Kernel> v2 = p1 - p2;
         return (v1 * v2) / (CGAL::sqrt(v1.squared_length()) * CGAL::sqrt(v2.squared_length()));
     }
 
+    /**
+     * Returns the sign of the cosine.
+     */
+    CGAL::Sign cosine_sign() const {
+        return CGAL::sign((p3 - p2) * (p1 - p2));
+    }
+
+    /**
+     * Returns the squared cosine, which is rational and thus exact without sqrt.
+     */
+    typename Kernel::FT squared_cosine() const {
+        CGAL::Vector_2<Kernel> v1 = p3 - p2;
+        CGAL::Vector_2<Kernel> v2 = p1 - p2;
+        typename Kernel::FT dot = v1 * v2;
+        return dot * dot / (v1.squared_length() * v2.squared_length());
+    }
+
+    /**
+     * Interval of the angle, computed from the exact squared cosine.
+     */
     ia::DoubleInterval interval() const {
-        return ia::acos(ia::get<Kernel>(cosine()));
+        ia::DoubleInterval cosine = ia::sqrt(ia::get<Kernel>(squared_cosine()));
+        if (cosine_sign() == CGAL::NEGATIVE) {
+            cosine = -cosine;
+        }
+        return ia::acos(ia::clamp_cosine(cosine));
+    }
+
+    /**
+     * Interval of the cosine, computed from the double approximations of the points without any exact construction.
+     * Contains the exact cosine, but is usually a bit wider than the interval of the exact cosine.
+     */
+    ia::DoubleInterval approximate_cosine() const {
+        ia::DoubleInterval v1_x = ia::get<Kernel>(p3.x()) - ia::get<Kernel>(p2.x());
+        ia::DoubleInterval v1_y = ia::get<Kernel>(p3.y()) - ia::get<Kernel>(p2.y());
+        ia::DoubleInterval v2_x = ia::get<Kernel>(p1.x()) - ia::get<Kernel>(p2.x());
+        ia::DoubleInterval v2_y = ia::get<Kernel>(p1.y()) - ia::get<Kernel>(p2.y());
+
+        ia::DoubleInterval squared_lengths = (ia::square(v1_x) + ia::square(v1_y)) *
+                (ia::square(v2_x) + ia::square(v2_y));
+        if (squared_lengths.lower() <= 0) {
+            return ia::DoubleInterval(-1, 1);
+        }
+        return ia::clamp_cosine((v1_x * v2_x + v1_y * v2_y) / ia::sqrt(squared_lengths));
+    }
+
+    /**
+     * Interval of the angle, computed from approximate_cosine. Usually wider than the interval returned by interval().
+     */
+    ia::DoubleInterval approximate_interval() const {
+        return ia::acos(approximate_cosine());
     }
 
 private:
@@ -54,7 +106,7 @@ private:
 };
 
 /**
- * Returns the cosine of the smalles inner angle of a given polygon.
+ * Returns the cosine of the smalles inner angle of a given polygon. Requires a kernel with sqrt.
  *
  * \pre Polygon is counterclockwise oriented.
  */
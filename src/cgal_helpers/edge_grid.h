@@ -0,0 +1,232 @@
+//
+// Uniform grid over the edge bounding boxes of a polygon, to find the edges near a query region.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_EDGE_GRID_H
+#define ANGULAR_ART_GALLERY_PROBLEM_EDGE_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <CGAL/Bbox_2.h>
+#include <CGAL/Kernel/global_functions_2.h>
+#include <CGAL/Polygon_2.h>
+#include <CGAL/Ray_2.h>
+
+
+/**
+ * Every edge i (from vertex i to vertex i + 1) is stored in all grid cells overlapped by its bounding box. A segment
+ * query visits only the cells along the segment. The grid has about one cell per edge.
+ *
+ * Additionally, the vertices are sorted lexicographically, such that the index of a vertex can be looked up.
+ */
+template <class Kernel>
+class EdgeGrid {
+public:
+    explicit EdgeGrid(CGAL::Polygon_2<Kernel> const & polygon) : polygon_(polygon), box(polygon.bbox()) {
+        std::size_t n = polygon.size();
+        columns = rows = std::max(1, (int)std::ceil(std::sqrt((double)n)));
+        cell_width = (box.xmax() - box.xmin()) / columns;
+        cell_height = (box.ymax() - box.ymin()) / rows;
+        cells.resize(columns * rows);
+
+        auto edge = polygon.edges_circulator();
+        for (std::size_t i = 0; i < n; ++i, ++edge) {
+            edge_boxes.push_back(edge->bbox());
+            CellRange range = cell_range(edge_boxes.back());
+            for (int y = range.y_min; y <= range.y_max; ++y) {
+                for (int x = range.x_min; x <= range.x_max; ++x) {
+                    cells[y * columns + x].push_back(i);
+                }
+            }
+        }
+
+        sorted_vertices.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            sorted_vertices[i] = i;
+        }
+        std::sort(sorted_vertices.begin(), sorted_vertices.end(), [&](std::size_t a, std::size_t b) {
+            return CGAL::compare_xy(polygon_[a], polygon_[b]) == CGAL::SMALLER;
+        });
+    }
+
+    CGAL::Polygon_2<Kernel> const & polygon() const {
+        return polygon_;
+    }
+
+    /**
+     * Calls f(i) for the edges i near the segment, until f returns true. Returns true, iff f returned true.
+     *
+     * Reported are all edges, whose bounding boxes overlap the bounding box of the segment and which are stored in a
+     * grid cell traversed by the segment. Thus, every edge intersecting the segment is reported (possibly more than
+     * once), but the order is unspecified.
+     */
+    template <class F>
+    bool find_edge(CGAL::Segment_2<Kernel> const & segment, F f) const {
+        double x_source = CGAL::to_double(segment.source().x());
+        double y_source = CGAL::to_double(segment.source().y());
+        double dx = CGAL::to_double(segment.target().x()) - x_source;
+        double dy = CGAL::to_double(segment.target().y()) - y_source;
+        CGAL::Bbox_2 segment_box = segment.bbox();
+        return find_edge_along_line(segment_box, segment_box, x_source, y_source, dx, dy, f);
+    }
+
+    /**
+     * Calls f(i) for the edges i near the ray, until f returns true. Returns true, iff f returned true.
+     *
+     * Reported are the edges near the ray, whose bounding boxes overlap the limit box. Thus, every edge intersecting the
+     * ray inside of the limit box is reported (possibly more than once). The cells are visited in order along the ray
+     * and f may shrink the limit box, e.g. to the part of the ray before the nearest hit so far, such that the farther
+     * cells are skipped.
+     */
+    template <class F>
+    bool find_edge(CGAL::Ray_2<Kernel> const & ray, CGAL::Bbox_2 const & limit, F f) const {
+        double x_source = CGAL::to_double(ray.source().x());
+        double y_source = CGAL::to_double(ray.source().y());
+        double dx = CGAL::to_double(ray.to_vector().x());
+        double dy = CGAL::to_double(ray.to_vector().y());
+        if (dx == 0 && dy == 0) {
+            return false;
+        }
+
+        // The ray is cut off at a point outside of the grid, which is farther away from the source than every grid
+        // point (in the L1 norm). The slack covers the rounding errors of this approximation.
+        double reach = std::abs(x_source - box.xmin()) + std::abs(x_source - box.xmax())
+                + std::abs(y_source - box.ymin()) + std::abs(y_source - box.ymax());
+        double scale = 2 * reach / (std::abs(dx) + std::abs(dy));
+        double x_end = x_source + scale * dx;
+        double y_end = y_source + scale * dy;
+        double epsilon = slack();
+        CGAL::Bbox_2 ray_box = ray.source().bbox() + CGAL::Bbox_2(x_end, y_end, x_end, y_end);
+        ray_box = CGAL::Bbox_2(ray_box.xmin() - epsilon, ray_box.ymin() - epsilon, ray_box.xmax() + epsilon,
+                ray_box.ymax() + epsilon);
+        return find_edge_along_line(ray_box, limit, x_source, y_source, x_end - x_source, y_end - y_source, f);
+    }
+
+    CGAL::Bbox_2 const & bbox() const {
+        return box;
+    }
+
+    /**
+     * Returns the index of the vertex at point p, or polygon().size(), if p is no vertex.
+     */
+    std::size_t vertex_index(CGAL::Point_2<Kernel> const & p) const {
+        auto it = std::lower_bound(sorted_vertices.begin(), sorted_vertices.end(), p,
+                [&](std::size_t a, CGAL::Point_2<Kernel> const & q) {
+                    return CGAL::compare_xy(polygon_[a], q) == CGAL::SMALLER;
+                });
+        if (it != sorted_vertices.end() && polygon_[*it] == p) {
+            return *it;
+        }
+        return polygon_.size();
+    }
+
+private:
+    CGAL::Polygon_2<Kernel> polygon_;
+    CGAL::Bbox_2 box;
+    int columns;
+    int rows;
+    double cell_width;
+    double cell_height;
+    std::vector<std::vector<std::size_t>> cells;
+    std::vector<CGAL::Bbox_2> edge_boxes;
+    std::vector<std::size_t> sorted_vertices;
+
+    // Slack for the rounding errors of approximated segments and rays
+    double slack() const {
+        return 1e-9 * (std::abs(box.xmin()) + std::abs(box.xmax()) + cell_width + std::abs(box.ymin())
+                + std::abs(box.ymax()) + cell_height);
+    }
+
+    /**
+     * Slack of the y-coordinates of the line from the source in direction (dx, dy), where it is clipped to a column.
+     * The rounding errors of the x-coordinates (of the line and of the column bounds) are amplified by the slope of the
+     * line, so near vertical lines are not clipped at all, once the slack covers the whole grid.
+     */
+    double clipping_slack(double x_source, double y_source, double dx, double dy) const {
+        double x_magnitude = std::abs(box.xmin()) + std::abs(box.xmax()) + cell_width + std::abs(x_source)
+                + std::abs(dx);
+        double y_magnitude = std::abs(box.ymin()) + std::abs(box.ymax()) + cell_height + std::abs(y_source)
+                + std::abs(dy);
+        return 1e-9 * (y_magnitude + x_magnitude * std::abs(dy / dx));
+    }
+
+    /**
+     * Reports the edges overlapping the limit box in the cells along the line from the source in direction (dx, dy),
+     * restricted to the query box. The cells are visited in the direction of the line and the limit box is read again
+     * for every cell.
+     */
+    template <class F>
+    bool find_edge_along_line(CGAL::Bbox_2 const & query, CGAL::Bbox_2 const & limit, double x_source, double y_source,
+            double dx, double dy, F f) const {
+        CellRange range = cell_range(query);
+        double epsilon = dx != 0 ? clipping_slack(x_source, y_source, dx, dy) : 0;
+
+        for (int column = 0; column <= range.x_max - range.x_min; ++column) {
+            int x = dx < 0 ? range.x_max - column : range.x_min + column;
+            CellRange limit_range = cell_range(limit);
+            if (x < limit_range.x_min || x > limit_range.x_max) {
+                continue;
+            }
+
+            int y_min = range.y_min;
+            int y_max = range.y_max;
+            if (range.x_min != range.x_max && dx != 0) {
+                // Clip the line to the column
+                double slab_min = std::max(query.xmin(), box.xmin() + x * cell_width);
+                double slab_max = std::min(query.xmax(), box.xmin() + (x + 1) * cell_width);
+                if (x == range.x_min) {
+                    slab_min = query.xmin();
+                }
+                if (x == range.x_max) {
+                    slab_max = query.xmax();
+                }
+                double y_1 = y_source + (slab_min - x_source) / dx * dy;
+                double y_2 = y_source + (slab_max - x_source) / dx * dy;
+                y_min = std::max(y_min, cell_coordinate(std::min(y_1, y_2) - epsilon, box.ymin(), cell_height, rows));
+                y_max = std::min(y_max, cell_coordinate(std::max(y_1, y_2) + epsilon, box.ymin(), cell_height, rows));
+            }
+
+            for (int row = 0; row <= y_max - y_min; ++row) {
+                int y = dy < 0 ? y_max - row : y_min + row;
+                limit_range = cell_range(limit);
+                if (y < limit_range.y_min || y > limit_range.y_max) {
+                    continue;
+                }
+                for (std::size_t i : cells[y * columns + x]) {
+                    if (CGAL::do_overlap(edge_boxes[i], limit) && f(i)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Cell coordinates are monotone in the point coordinates, such that overlapping boxes always share a cell.
+     */
+    static int cell_coordinate(double value, double min, double size, int count) {
+        if (size <= 0) {
+            return 0;
+        }
+        double cell = std::floor((value - min) / size);
+        return (int)std::max(0.0, std::min(cell, (double)(count - 1)));
+    }
+
+    struct CellRange {
+        int x_min, x_max, y_min, y_max;
+    };
+
+    CellRange cell_range(CGAL::Bbox_2 const & query) const {
+        return {
+            cell_coordinate(query.xmin(), box.xmin(), cell_width, columns),
+            cell_coordinate(query.xmax(), box.xmin(), cell_width, columns),
+            cell_coordinate(query.ymin(), box.ymin(), cell_height, rows),
+            cell_coordinate(query.ymax(), box.ymin(), cell_height, rows)
+        };
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_EDGE_GRID_H
@@ -7,6 +7,8 @@
 #ifndef ANGULARARTGALLERYPROBLEM_INTERVAL_ARITHMETIC_H
 #define ANGULARARTGALLERYPROBLEM_INTERVAL_ARITHMETIC_H
 
+#include <algorithm>
+
 #include <boost/numeric/interval.hpp>
 #include <CGAL/Interval_nt.h>
 
@@ -49,6 +51,17 @@ namespace ia {
         return DoubleInterval(i.inf(), i.sup());
     }
 
+    static DoubleInterval square(DoubleInterval interval) {
+        return boost::numeric::square(interval);
+    }
+
+    /**
+     * Intersects the interval with [-1, 1], the range of a cosine.
+     */
+    static DoubleInterval clamp_cosine(DoubleInterval interval) {
+        return DoubleInterval(std::max(interval.lower(), -1.0), std::min(interval.upper(), 1.0));
+    }
+
     static DoubleInterval sqrt(DoubleInterval interval) {
         return boost::numeric::sqrt(interval);
     }
@@ -0,0 +1,107 @@
+//
+// Uniform grid over a set of points, to find the points in a query region.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_POINT_GRID_H
+#define ANGULAR_ART_GALLERY_PROBLEM_POINT_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <CGAL/Bbox_2.h>
+#include <CGAL/Point_2.h>
+
+
+/**
+ * Every point is stored in all grid cells overlapped by its bounding box (which is a single cell, unless the point
+ * coordinates are not exactly representable as doubles). The grid has about one cell per point.
+ */
+template <class Kernel>
+class PointGrid {
+public:
+    explicit PointGrid(std::vector<CGAL::Point_2<Kernel>> points) : points(std::move(points)) {
+        for (auto const & point : this->points) {
+            point_boxes.push_back(point.bbox());
+            box = point_boxes.size() == 1 ? point_boxes.back() : box + point_boxes.back();
+        }
+
+        columns = rows = std::max(1, (int)std::ceil(std::sqrt((double)this->points.size())));
+        cell_width = (box.xmax() - box.xmin()) / columns;
+        cell_height = (box.ymax() - box.ymin()) / rows;
+        cells.resize(columns * rows);
+        for (std::size_t i = 0; i < this->points.size(); ++i) {
+            CellRange range = cell_range(point_boxes[i]);
+            for (int y = range.y_min; y <= range.y_max; ++y) {
+                for (int x = range.x_min; x <= range.x_max; ++x) {
+                    cells[y * columns + x].push_back(i);
+                }
+            }
+        }
+    }
+
+    std::size_t size() const {
+        return points.size();
+    }
+
+    /**
+     * Calls f(p) for the points p near the query box, until f returns true. Returns true, iff f returned true.
+     *
+     * Reported are all points, whose bounding boxes overlap the query box (possibly more than once), in unspecified
+     * order.
+     */
+    template <class F>
+    bool find_point(CGAL::Bbox_2 const & query, F f) const {
+        if (points.empty() || !CGAL::do_overlap(box, query)) {
+            return false;
+        }
+
+        CellRange range = cell_range(query);
+        for (int y = range.y_min; y <= range.y_max; ++y) {
+            for (int x = range.x_min; x <= range.x_max; ++x) {
+                for (std::size_t i : cells[y * columns + x]) {
+                    if (CGAL::do_overlap(point_boxes[i], query) && f(points[i])) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<CGAL::Point_2<Kernel>> points;
+    std::vector<CGAL::Bbox_2> point_boxes;
+    CGAL::Bbox_2 box;
+    int columns;
+    int rows;
+    double cell_width;
+    double cell_height;
+    std::vector<std::vector<std::size_t>> cells;
+
+    /**
+     * Cell coordinates are monotone in the point coordinates, such that overlapping boxes always share a cell.
+     */
+    static int cell_coordinate(double value, double min, double size, int count) {
+        if (size <= 0) {
+            return 0;
+        }
+        double cell = std::floor((value - min) / size);
+        return (int)std::max(0.0, std::min(cell, (double)(count - 1)));
+    }
+
+    struct CellRange {
+        int x_min, x_max, y_min, y_max;
+    };
+
+    CellRange cell_range(CGAL::Bbox_2 const & query) const {
+        return {
+            cell_coordinate(query.xmin(), box.xmin(), cell_width, columns),
+            cell_coordinate(query.xmax(), box.xmin(), cell_width, columns),
+            cell_coordinate(query.ymin(), box.ymin(), cell_height, rows),
+            cell_coordinate(query.ymax(), box.ymin(), cell_height, rows)
+        };
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_POINT_GRID_H
@@ -7,6 +7,8 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_RANDOM_POLYGON_GENERATOR_H
 #define ANGULAR_ART_GALLERY_PROBLEM_RANDOM_POLYGON_GENERATOR_H
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 #include <CGAL/Kernel/global_functions_2.h>
@@ -14,6 +16,8 @@
 #include <CGAL/Polygon_2.h>
 #include <CGAL/random_polygon_2.h>
 
+#include "polygon_normalization.h"
+
 
 template <typename Kernel>
 class RandomPolygonGenerator {
@@ -34,12 +38,12 @@ public:
             while (points.size() != size) {
                 CGAL::Point_2<Kernel> new_point(dis(gen), dis(gen));
                 bool good_point = true;
-                for (int i = 0; i < points.size() && good_point; ++i) {
+                for (std::size_t i = 0; i < points.size() && good_point; ++i) {
                     if (points[i] == new_point) {
                         good_point = false;
                     }
 
-                    for (int j = i + 1; j < points.size() && good_point; ++j) {
+                    for (std::size_t j = i + 1; j < points.size() && good_point; ++j) {
                         if (CGAL::collinear(points[i], points[j], new_point)) {
                             good_point = false;
                         }
@@ -63,6 +67,102 @@ public:
         }
     }
 
+    /**
+     * Creates a random polygon, which is star-shaped with respect to the center of the value range. Much faster than
+     * generate, such that it is suitable for large polygons.
+     */
+    CGAL::Polygon_2<Kernel> generate_star_shaped(size_t size) {
+        double center = (DEFAULT_MIN_VALUE + DEFAULT_MAX_VALUE) / 2;
+        std::uniform_real_distribution<double> angle_dis(0, 2 * M_PI);
+        std::uniform_real_distribution<double> radius_dis(0.1 * center, center);
+
+        while (true) {
+            std::vector<double> angles(size);
+            for (double & angle : angles) {
+                angle = angle_dis(gen);
+            }
+            std::sort(angles.begin(), angles.end());
+
+            CGAL::Polygon_2<Kernel> polygon;
+            for (double angle : angles) {
+                double radius = radius_dis(gen);
+                polygon.push_back(CGAL::Point_2<Kernel>(center + radius * std::cos(angle),
+                                                        center + radius * std::sin(angle)));
+            }
+
+            if (polygon.is_simple() && is_normalized(polygon)) {
+                return polygon;
+            }
+        }
+    }
+
+    /**
+     * Creates a random orthogonal polygon with integer coordinates: a histogram of bars with random heights over a
+     * common base edge. Orthogonal polygons have an even size, thus odd sizes are rounded down (at least 4).
+     */
+    CGAL::Polygon_2<Kernel> generate_orthogonal(size_t size) {
+        size_t bars = std::max<size_t>(size, 4) / 2 - 1;
+        int width = std::max(1, (int)(DEFAULT_MAX_VALUE - DEFAULT_MIN_VALUE) / (int)bars);
+        std::uniform_int_distribution<int> height_dis(1, (int)(DEFAULT_MAX_VALUE - DEFAULT_MIN_VALUE));
+
+        std::vector<int> heights(bars);
+        for (size_t i = 0; i < bars; ++i) {
+            do {
+                heights[i] = height_dis(gen);
+            } while (i > 0 && heights[i] == heights[i - 1]);
+        }
+
+        CGAL::Polygon_2<Kernel> polygon;
+        polygon.push_back(CGAL::Point_2<Kernel>(0, 0));
+        polygon.push_back(CGAL::Point_2<Kernel>(width * (int)bars, 0));
+        for (size_t i = bars; i-- > 0;) {
+            polygon.push_back(CGAL::Point_2<Kernel>(width * (int)(i + 1), heights[i]));
+            polygon.push_back(CGAL::Point_2<Kernel>(width * (int)i, heights[i]));
+        }
+        return polygon;
+    }
+
+    /**
+     * Creates a random spiral polygon: a corridor of random width, which winds around the center. The number of turns
+     * grows with the square root of the size, such that the turns stay smooth (at least 16 vertices).
+     */
+    CGAL::Polygon_2<Kernel> generate_spiral(size_t size) {
+        size = std::max<size_t>(size, 16);
+        size_t n_inner = size / 2;
+        size_t n_outer = size - n_inner;
+        double turns = std::max(1.0, std::sqrt(n_inner / 16.0));
+
+        // The radius grows by 1 per turn, the corridor is about half as wide, such that the turns never touch
+        double center = (DEFAULT_MIN_VALUE + DEFAULT_MAX_VALUE) / 2;
+        double scale = center / (turns + 1.5);
+        std::uniform_real_distribution<double> jitter_dis(0, 0.15);
+
+        auto point = [&](double fraction, double offset) {
+            double angle = 2 * M_PI * turns * fraction;
+            double radius = scale * (1 + turns * fraction + offset);
+            return CGAL::Point_2<Kernel>(center + radius * std::cos(angle), center + radius * std::sin(angle));
+        };
+
+        while (true) {
+            CGAL::Polygon_2<Kernel> polygon;
+            for (size_t i = 0; i < n_outer; ++i) {
+                polygon.push_back(point((double)i / (n_outer - 1), jitter_dis(gen)));
+            }
+            for (size_t i = n_inner; i-- > 0;) {
+                polygon.push_back(point((double)i / (n_inner - 1), -0.5 + jitter_dis(gen)));
+            }
+
+            if (polygon.is_simple()) {
+                if (polygon.is_clockwise_oriented()) {
+                    polygon.reverse_orientation();
+                }
+                if (is_normalized(polygon)) {
+                    return polygon;
+                }
+            }
+        }
+    }
+
     unsigned int getSeed() {
         return rand.get_seed();
     }
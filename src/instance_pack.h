@@ -0,0 +1,314 @@
+//
+// Binary pack of many AAGP instances in a single file, which is memory mapped for reading.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_INSTANCE_PACK_H
+#define ANGULAR_ART_GALLERY_PROBLEM_INSTANCE_PACK_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <CGAL/Polygon_2.h>
+
+#include "serialization.h"
+
+
+/**
+ * Layout of a pack file (native byte order, all sections 8 byte aligned):
+ * - PackHeader
+ * - PackEntry for every instance
+ * - PackedNumber for both coordinates of every vertex of every instance
+ * - Instance names and numbers, which are stored as text
+ *
+ * A coordinate of the instance format with at most 18 significant decimal digits is stored exactly as mantissa and
+ * decimal exponent. All other coordinates (e.g. fractions) are stored as text.
+ */
+struct PackHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t instances;
+};
+
+struct PackEntry {
+    std::uint64_t name_offset;
+    std::uint32_t name_length;
+    std::uint32_t size;
+    std::uint64_t coordinates_offset;
+};
+
+/**
+ * The value is mantissa * 10^exponent, if length is 0. Otherwise, mantissa is the file offset of the number as text.
+ */
+struct PackedNumber {
+    std::int64_t mantissa;
+    std::int32_t exponent;
+    std::uint32_t length;
+};
+
+static constexpr char PACK_MAGIC[8] = {'A', 'A', 'G', 'P', 'P', 'A', 'C', 'K'};
+static constexpr std::uint32_t PACK_VERSION = 1;
+
+/**
+ * Collects instances in memory and writes the pack file at once.
+ */
+class InstancePackWriter {
+public:
+    /**
+     * Adds an instance file under the given name (usually its path relative to the instance base directory). The
+     * coordinates are copied without converting them to a number type.
+     */
+    void add_file(fs::path const & path, std::string const & name) {
+        if (!fs::is_regular_file(path)) {
+            throw std::invalid_argument("Not a file: " + path.string());
+        }
+
+        // Only the tokens are validated here, the numbers are converted by the readers of the pack
+        std::string text = serialization::read_text(path.string());
+        char const * it = text.data();
+        char const * end = it + text.size();
+        std::size_t size = 0;
+        if (!serialization::next_size(it, end, size)) {
+            throw std::runtime_error("Invalid instance file: " + path.string());
+        }
+
+        Instance instance{name, {}};
+        serialization::NumberToken token;
+        try {
+            while (serialization::next_number_token(it, end, token)) {
+                instance.coordinates.emplace_back(token.text);
+            }
+        } catch (std::runtime_error const & e) {
+            throw std::runtime_error(path.string() + ": " + e.what());
+        }
+        if (instance.coordinates.size() != 2 * size) {
+            throw std::runtime_error("Invalid instance file: " + path.string());
+        }
+        instances.push_back(std::move(instance));
+    }
+
+    std::size_t size() const {
+        return instances.size();
+    }
+
+    void write(fs::path const & path) const {
+        std::uint64_t coordinates_offset = sizeof(PackHeader) + instances.size() * sizeof(PackEntry);
+        std::uint64_t text_offset = coordinates_offset;
+        for (Instance const & instance : instances) {
+            text_offset += instance.coordinates.size() * sizeof(PackedNumber);
+        }
+
+        std::vector<PackEntry> entries;
+        std::vector<PackedNumber> numbers;
+        std::string text;
+        for (Instance const & instance : instances) {
+            entries.push_back(PackEntry{
+                text_offset + text.size(),
+                (std::uint32_t)instance.name.size(),
+                (std::uint32_t)(instance.coordinates.size() / 2),
+                coordinates_offset + numbers.size() * sizeof(PackedNumber)
+            });
+            text += instance.name;
+
+            for (std::string const & coordinate : instance.coordinates) {
+                PackedNumber number{};
+                if (!to_decimal(coordinate, number)) {
+                    number = PackedNumber{(std::int64_t)(text_offset + text.size()), 0,
+                                          (std::uint32_t)coordinate.size()};
+                    text += coordinate;
+                }
+                numbers.push_back(number);
+            }
+        }
+
+        PackHeader header{};
+        std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+        header.version = PACK_VERSION;
+        header.instances = instances.size();
+
+        std::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<char const *>(entries.data()), entries.size() * sizeof(PackEntry));
+        stream.write(reinterpret_cast<char const *>(numbers.data()), numbers.size() * sizeof(PackedNumber));
+        stream.write(text.data(), text.size());
+        if (!stream) {
+            throw std::runtime_error("Couldn't write file " + path.string());
+        }
+    }
+
+private:
+    struct Instance {
+        std::string name;
+        std::vector<std::string> coordinates;
+    };
+
+    std::vector<Instance> instances;
+
+    /**
+     * Packs a number with at most 18 significant decimal digits as mantissa and exponent. Returns false for other
+     * numbers and for exponents, which the readers reject (see serialization::MAX_DECIMAL_EXPONENT).
+     */
+    static bool to_decimal(std::string const & str, PackedNumber & number) {
+        char const * it = str.data();
+        serialization::NumberToken token;
+        serialization::next_number_token(it, it + str.size(), token);
+
+        std::int64_t mantissa = 0;
+        long exponent = 0;
+        if (!serialization::to_decimal(token, mantissa, exponent) || std::abs(exponent) > serialization::MAX_DECIMAL_EXPONENT) {
+            return false;
+        }
+        number = PackedNumber{mantissa, (std::int32_t)exponent, 0};
+        return true;
+    }
+};
+
+/**
+ * Read-only view of a pack file. The file is memory mapped, such that the instances can be accessed by index without
+ * reading the whole pack.
+ */
+class InstancePack {
+public:
+    /**
+     * \throws std::runtime_error if the file is no valid pack, i.e. its header, entries, names or coordinates are not
+     * inside of the file
+     */
+    explicit InstancePack(fs::path const & path) : path_(path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::invalid_argument("Not a file: " + path.string());
+        }
+        struct stat status {};
+        if (::fstat(fd, &status) != 0 || (std::size_t)status.st_size < sizeof(PackHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Invalid instance pack: " + path.string());
+        }
+
+        length = status.st_size;
+        void * mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Couldn't map file " + path.string());
+        }
+        data = static_cast<char const *>(mapping);
+
+        if (!valid()) {
+            ::munmap(const_cast<char *>(data), length);
+            throw std::runtime_error("Invalid instance pack: " + path.string());
+        }
+    }
+
+    InstancePack(InstancePack const &) = delete;
+    InstancePack & operator=(InstancePack const &) = delete;
+
+    ~InstancePack() {
+        ::munmap(const_cast<char *>(data), length);
+    }
+
+    /**
+     * Returns true, iff the file starts like a pack file.
+     */
+    static bool is_pack(fs::path const & path) {
+        std::ifstream stream(path, std::ios::binary);
+        char magic[sizeof(PACK_MAGIC)] = {};
+        stream.read(magic, sizeof(magic));
+        return stream && std::memcmp(magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0;
+    }
+
+    std::size_t size() const {
+        return header().instances;
+    }
+
+    std::string_view name(std::size_t i) const {
+        PackEntry const & e = entry(i);
+        return std::string_view(data + e.name_offset, e.name_length);
+    }
+
+    std::size_t polygon_size(std::size_t i) const {
+        return entry(i).size;
+    }
+
+    template <class Kernel>
+    CGAL::Polygon_2<Kernel> polygon(std::size_t i) const {
+        using FT = typename Kernel::FT;
+        PackEntry const & e = entry(i);
+        PackedNumber const * numbers = reinterpret_cast<PackedNumber const *>(data + e.coordinates_offset);
+
+        CGAL::Polygon_2<Kernel> polygon;
+        for (std::size_t k = 0; k < e.size; ++k) {
+            polygon.push_back(CGAL::Point_2<Kernel>(number<FT>(numbers[2 * k]), number<FT>(numbers[2 * k + 1])));
+        }
+        return polygon;
+    }
+
+private:
+    fs::path path_;
+    char const * data = nullptr;
+    std::size_t length = 0;
+
+    /**
+     * Returns true, iff the count bytes at offset are inside of the file.
+     */
+    bool in_file(std::uint64_t offset, std::uint64_t count) const {
+        return offset <= length && count <= length - offset;
+    }
+
+    /**
+     * Checks the header and the ranges of all entries once, such that the entries can be accessed without checks.
+     */
+    bool valid() const {
+        if (std::memcmp(header().magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header().version != PACK_VERSION ||
+                size() > (length - sizeof(PackHeader)) / sizeof(PackEntry)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < size(); ++i) {
+            PackEntry const & e = entry(i);
+            if (!in_file(e.name_offset, e.name_length) || e.coordinates_offset % alignof(PackedNumber) != 0 ||
+                    !in_file(e.coordinates_offset, 2 * (std::uint64_t)e.size * sizeof(PackedNumber))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    PackHeader const & header() const {
+        return *reinterpret_cast<PackHeader const *>(data);
+    }
+
+    PackEntry const & entry(std::size_t i) const {
+        return reinterpret_cast<PackEntry const *>(data + sizeof(PackHeader))[i];
+    }
+
+    template <class FT>
+    FT number(PackedNumber const & packed) const {
+        if (packed.length == 0) {
+            if (std::abs((long)packed.exponent) > serialization::MAX_DECIMAL_EXPONENT) {
+                throw std::runtime_error("Invalid instance pack: " + path_.string());
+            }
+            return serialization::decimal_number<FT>(packed.mantissa, packed.exponent);
+        }
+
+        if (packed.mantissa < 0 || !in_file(packed.mantissa, packed.length)) {
+            throw std::runtime_error("Invalid instance pack: " + path_.string());
+        }
+        char const * it = data + packed.mantissa;
+        serialization::NumberToken token;
+        if (!serialization::next_number_token(it, it + packed.length, token)) {
+            throw std::runtime_error("Invalid number in instance pack");
+        }
+        return serialization::to_number<FT>(token);
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_INSTANCE_PACK_H
@@ -7,10 +7,22 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_KERNEL_DEFINITIONS_H
 #define ANGULAR_ART_GALLERY_PROBLEM_KERNEL_DEFINITIONS_H
 
-#include "CGAL/Exact_predicates_exact_constructions_kernel_with_sqrt.h"
 #include "CGAL/Polygon_2.h"
 
+// The solver needs no square roots, such that the faster Epeck kernel (with rational numbers) can be used instead of the
+// kernel with sqrt by defining AAGP_EPECK_KERNEL.
+//
+// The threads of a single solver run share the polygon vertices (see UpperBoundSolver::set_threads). This is only
+// supported for the Epeck kernel, whose lazy numbers are thread safe.
+#ifdef AAGP_EPECK_KERNEL
+#include "CGAL/Exact_predicates_exact_constructions_kernel.h"
+using Kernel = CGAL::Exact_predicates_exact_constructions_kernel;
+constexpr bool KERNEL_THREAD_SAFE = true;
+#else
+#include "CGAL/Exact_predicates_exact_constructions_kernel_with_sqrt.h"
 using Kernel = CGAL::Exact_predicates_exact_constructions_kernel_with_sqrt;
+constexpr bool KERNEL_THREAD_SAFE = false;
+#endif
 
 using Circle = CGAL::Circle_2<Kernel>;
 using FT = Kernel::FT;
@@ -0,0 +1,385 @@
+//
+// Parser for the coordinates of instance files, which reads decimal numbers and fractions into exact numbers.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_NUMBER_PARSER_H
+#define ANGULAR_ART_GALLERY_PROBLEM_NUMBER_PARSER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <CGAL/Algebraic_structure_traits.h>
+#include <CGAL/Polygon_2.h>
+
+
+namespace serialization {
+    /**
+     * A number of the instance formats: a decimal number with optional exponent (e.g. "-5.4e-1") or a fraction of
+     * integers (e.g. "-27/50", as in AGPLIB). The digits are views into the parsed text.
+     */
+    struct NumberToken {
+        std::string_view text;
+        bool negative = false;
+        std::string_view integer_digits;     // Digits before the decimal point, or the numerator
+        std::string_view fraction_digits;    // Digits after the decimal point
+        std::string_view denominator_digits; // Empty for decimal numbers
+        long exponent = 0;
+    };
+
+    // Larger decimal exponents are rejected, instead of building huge numbers
+    static constexpr long MAX_DECIMAL_EXPONENT = 4096;
+
+    // Number of decimal digits, which always fit into std::int64_t
+    static constexpr std::size_t INT64_DIGITS = 18;
+
+    static bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    }
+
+    static char const * skip_digits(char const * it, char const * end) {
+        while (it != end && is_digit(*it)) {
+            ++it;
+        }
+        return it;
+    }
+
+    /**
+     * Skips whitespace and reads the number starting there. Returns false, if only whitespace is left.
+     * \throws std::runtime_error if the next token is no number
+     */
+    static bool next_number_token(char const * & it, char const * end, NumberToken & token) {
+        while (it != end && is_space(*it)) {
+            ++it;
+        }
+        if (it == end) {
+            return false;
+        }
+
+        char const * start = it;
+        token = NumberToken();
+        if (*it == '-' || *it == '+') {
+            token.negative = *it == '-';
+            ++it;
+        }
+
+        char const * digits = it;
+        it = skip_digits(it, end);
+        token.integer_digits = std::string_view(digits, it - digits);
+
+        bool point = it != end && *it == '.';
+        if (point) {
+            digits = ++it;
+            it = skip_digits(it, end);
+            token.fraction_digits = std::string_view(digits, it - digits);
+        }
+
+        bool valid = !token.integer_digits.empty() || !token.fraction_digits.empty();
+        if (valid && it != end && (*it == 'e' || *it == 'E')) {
+            ++it;
+            if (it != end && *it == '+') {
+                ++it;
+            }
+            auto result = std::from_chars(it, end, token.exponent);
+            valid = result.ec == std::errc() && std::abs(token.exponent) <= MAX_DECIMAL_EXPONENT;
+            it = result.ptr;
+        } else if (valid && !point && it != end && *it == '/') {
+            digits = ++it;
+            it = skip_digits(it, end);
+            token.denominator_digits = std::string_view(digits, it - digits);
+            valid = token.denominator_digits.find_first_not_of('0') != std::string_view::npos;
+        }
+
+        if (!valid || (it != end && !is_space(*it))) {
+            while (it != end && !is_space(*it)) {
+                ++it;
+            }
+            throw std::runtime_error("Invalid number: " + std::string(start, it - start));
+        }
+        token.text = std::string_view(start, it - start);
+        return true;
+    }
+
+    /**
+     * Skips whitespace and reads the number of vertices, which starts an instance. Returns false, if there is none.
+     */
+    static bool next_size(char const * & it, char const * end, std::size_t & size) {
+        while (it != end && is_space(*it)) {
+            ++it;
+        }
+        auto result = std::from_chars(it, end, size);
+        if (result.ec != std::errc() || (result.ptr != end && !is_space(*result.ptr))) {
+            return false;
+        }
+        it = result.ptr;
+        return true;
+    }
+
+    /**
+     * Converts a decimal number with at most 18 significant digits to mantissa * 10^exponent. Returns false for other
+     * numbers.
+     */
+    static bool to_decimal(NumberToken const & token, std::int64_t & mantissa, long & exponent) {
+        if (!token.denominator_digits.empty()) {
+            return false;
+        }
+
+        mantissa = 0;
+        exponent = token.exponent - (long)token.fraction_digits.size();
+        std::size_t digits = 0;
+        for (std::string_view part : {token.integer_digits, token.fraction_digits}) {
+            for (char c : part) {
+                if (mantissa == 0 && c == '0') {
+                    continue;
+                }
+                if (++digits > INT64_DIGITS) {
+                    return false;
+                }
+                mantissa = 10 * mantissa + (c - '0');
+            }
+        }
+        mantissa = token.negative ? -mantissa : mantissa;
+        return true;
+    }
+
+    template <class T, class = void>
+    struct has_exact_type : std::false_type { };
+
+    template <class T>
+    struct has_exact_type<T, std::void_t<typename T::ET>> : std::true_type { };
+
+    /**
+     * The exact number type of a lazy number type (e.g. of the Epeck kernel), or the number type itself.
+     */
+    template <class T, class = void>
+    struct exact_type {
+        using type = T;
+    };
+
+    template <class T>
+    struct exact_type<T, std::void_t<typename T::ET>> {
+        using type = typename T::ET;
+    };
+
+    /**
+     * Value of a digit sequence of any length, accumulated in blocks of 18 digits.
+     */
+    template <class Number>
+    Number digits_value(std::string_view digits) {
+        Number value(0);
+        while (!digits.empty()) {
+            std::size_t length = std::min(digits.size(), INT64_DIGITS);
+            std::int64_t block = 0;
+            std::from_chars(digits.data(), digits.data() + length, block);
+
+            std::int64_t scale = 1;
+            for (std::size_t k = 0; k < length; ++k) {
+                scale *= 10;
+            }
+            value = value * Number((long)scale) + Number((long)block);
+            digits.remove_prefix(length);
+        }
+        return value;
+    }
+
+    template <class Number>
+    Number power_of_ten(long exponent) {
+        Number power(1);
+        for (long k = 0; k < exponent; ++k) {
+            power *= Number(10);
+        }
+        return power;
+    }
+
+    /**
+     * Exact value of the token in a rational number type.
+     */
+    template <class Rational>
+    Rational rational_value(NumberToken const & token) {
+        Rational value;
+        if (token.denominator_digits.empty()) {
+            long exponent = token.exponent - (long)token.fraction_digits.size();
+            value = digits_value<Rational>(token.integer_digits) * power_of_ten<Rational>(token.fraction_digits.size())
+                    + digits_value<Rational>(token.fraction_digits);
+            if (exponent >= 0) {
+                value = value * power_of_ten<Rational>(exponent);
+            } else {
+                value = value / power_of_ten<Rational>(-exponent);
+            }
+        } else {
+            value = digits_value<Rational>(token.integer_digits) / digits_value<Rational>(token.denominator_digits);
+        }
+        return token.negative ? Rational(-value) : value;
+    }
+
+    /**
+     * Value of a digit sequence with at most 18 digits. Returns false for longer sequences.
+     */
+    static bool small_digits_value(std::string_view digits, std::int64_t & value) {
+        value = 0;
+        return digits.size() <= INT64_DIGITS &&
+                std::from_chars(digits.data(), digits.data() + digits.size(), value).ec == std::errc();
+    }
+
+    /**
+     * Exact mantissa * 10^exponent in a number type with square roots, as the quotient (or product) of two integers.
+     * Returns false, if 10^|exponent| does not fit into std::int64_t.
+     */
+    template <class FT>
+    bool small_decimal_value(std::int64_t mantissa, long exponent, FT & value) {
+        if (std::abs(exponent) > (long)INT64_DIGITS) {
+            return false;
+        }
+        std::int64_t power = 1;
+        for (long k = 0; k < std::abs(exponent); ++k) {
+            power *= 10;
+        }
+
+        // The product or quotient is built in the exact number type, such that the lazy number type holds it as one
+        // constant. The exact number type may still represent it as an operation of the two integers (e.g. a division
+        // node of CORE::Expr), which is much smaller than an expression of the digit blocks.
+        using Number = typename exact_type<FT>::type;
+        Number number((long)mantissa);
+        if (power != 1) {
+            number = exponent > 0 ? Number(number * Number((long)power)) : Number(number / Number((long)power));
+        }
+        value = FT(number);
+        return true;
+    }
+
+    /**
+     * Converts the token to the number type of a kernel.
+     *
+     * Rational number types (e.g. of the Epeck kernel) are built from the digits directly. Number types with square
+     * roots (of the kernel with sqrt) are built from the mantissa and exponent, if they fit into std::int64_t, and from
+     * the text of the token otherwise. Thus, the number is at most an operation of two integers instead of an expression
+     * of the digit blocks.
+     */
+    template <class FT>
+    FT to_number(NumberToken const & token) {
+        using Category = typename CGAL::Algebraic_structure_traits<FT>::Algebraic_category;
+        if constexpr (!std::is_same_v<Category, CGAL::Field_tag>) {
+            using Number = typename exact_type<FT>::type;
+            std::int64_t mantissa, denominator;
+            long exponent;
+            FT value;
+            if (token.denominator_digits.empty()) {
+                if (to_decimal(token, mantissa, exponent) && small_decimal_value(mantissa, exponent, value)) {
+                    return value;
+                }
+                return FT(std::string(token.text));
+            }
+            if (small_digits_value(token.integer_digits, mantissa) &&
+                    small_digits_value(token.denominator_digits, denominator)) {
+                mantissa = token.negative ? -mantissa : mantissa;
+                return FT(Number(Number((long)mantissa) / Number((long)denominator)));
+            }
+            FT numerator(std::string(token.integer_digits));
+            FT quotient = numerator / FT(std::string(token.denominator_digits));
+            return token.negative ? FT(-quotient) : quotient;
+        } else if constexpr (has_exact_type<FT>::value) {
+            return FT(rational_value<typename FT::ET>(token));
+        } else {
+            return rational_value<FT>(token);
+        }
+    }
+
+    /**
+     * Converts mantissa * 10^exponent (see to_decimal) to the number type of a kernel, like to_number.
+     */
+    template <class FT>
+    FT decimal_number(std::int64_t mantissa, long exponent) {
+        using Category = typename CGAL::Algebraic_structure_traits<FT>::Algebraic_category;
+        if constexpr (!std::is_same_v<Category, CGAL::Field_tag>) {
+            FT value;
+            if (small_decimal_value(mantissa, exponent, value)) {
+                return value;
+            }
+            std::string text = std::to_string(mantissa);
+            if (exponent != 0) {
+                text += "e" + std::to_string(exponent);
+            }
+            return FT(text);
+        } else {
+            using Rational = typename exact_type<FT>::type;
+            Rational value((long)mantissa);
+            if (exponent >= 0) {
+                value = value * power_of_ten<Rational>(exponent);
+            } else {
+                value = value / power_of_ten<Rational>(-exponent);
+            }
+            return FT(value);
+        }
+    }
+
+    /**
+     * Parses an instance: the number of vertices, followed by the coordinates of the vertices.
+     * \throws std::runtime_error if the text is no valid instance
+     */
+    template <class Kernel>
+    CGAL::Polygon_2<Kernel> parse_polygon(std::string_view text) {
+        using FT = typename Kernel::FT;
+
+        char const * it = text.data();
+        char const * end = it + text.size();
+        std::size_t size = 0;
+        if (!next_size(it, end, size)) {
+            throw std::runtime_error("Missing number of vertices");
+        }
+
+        CGAL::Polygon_2<Kernel> polygon;
+        NumberToken x, y;
+        while (next_number_token(it, end, x)) {
+            if (!next_number_token(it, end, y)) {
+                throw std::runtime_error("Missing y-coordinate of the last vertex");
+            }
+            polygon.push_back(CGAL::Point_2<Kernel>(to_number<FT>(x), to_number<FT>(y)));
+        }
+
+        if (polygon.size() != size) {
+            throw std::runtime_error("Expected " + std::to_string(size) + " vertices, found " +
+                    std::to_string(polygon.size()));
+        }
+        return polygon;
+    }
+
+    /**
+     * Reads the whole file with a single read.
+     */
+    static std::string read_text(std::string const & filename) {
+        std::ifstream stream(filename, std::ios::binary);
+        if (!stream) {
+            throw std::invalid_argument("Not a file: " + filename);
+        }
+        std::ostringstream text;
+        text << stream.rdbuf();
+        return text.str();
+    }
+
+    /**
+     * Reads an instance file (.pol or AGPLIB format).
+     * \throws std::runtime_error if the file is no valid instance
+     */
+    template <class Kernel>
+    CGAL::Polygon_2<Kernel> read_polygon(std::string const & filename) {
+        std::string text = read_text(filename);
+        try {
+            return parse_polygon<Kernel>(text);
+        } catch (std::runtime_error const & e) {
+            throw std::runtime_error(filename + ": " + e.what());
+        }
+    }
+}
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_NUMBER_PARSER_H
@@ -0,0 +1,48 @@
+//
+// Cooperative cancellation of a solve, which is checked by the solver and the patterns between units of work.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_CANCELLATION_TOKEN_H
+#define ANGULAR_ART_GALLERY_PROBLEM_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+
+
+/**
+ * A token is cancelled explicitly or when its deadline has passed. Once cancelled, it stays cancelled, such that all
+ * threads, which check it, stop consistently. The token may be checked concurrently.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * A token without deadline, which is only cancelled by cancel().
+     */
+    CancellationToken() = default;
+
+    explicit CancellationToken(Clock::time_point deadline) : deadline(deadline), has_deadline(true) {}
+
+    void cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (has_deadline && Clock::now() >= deadline) {
+            cancelled_.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    Clock::time_point deadline;
+    bool has_deadline = false;
+    mutable std::atomic<bool> cancelled_{false};
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_CANCELLATION_TOKEN_H
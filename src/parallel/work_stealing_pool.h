@@ -0,0 +1,169 @@
+//
+// Thread pool with one task queue per worker. Idle workers steal tasks from the queues of other workers.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_WORK_STEALING_POOL_H
+#define ANGULAR_ART_GALLERY_PROBLEM_WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Every worker owns a queue. Tasks submitted from outside the pool are distributed round-robin over the queues, tasks
+ * submitted by a worker are appended to its own queue. Workers (and thieves) always take the oldest task of a queue,
+ * so tasks submitted in order of decreasing cost are started in that order.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned int n_workers) {
+        n_workers = std::max(1u, n_workers);
+        for (unsigned int i = 0; i < n_workers; ++i) {
+            queues.emplace_back(std::make_unique<Queue>());
+        }
+        for (unsigned int i = 0; i < n_workers; ++i) {
+            threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    WorkStealingPool(WorkStealingPool const &) = delete;
+    WorkStealingPool & operator=(WorkStealingPool const &) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            stopping = true;
+        }
+        work_available.notify_all();
+        for (auto & thread : threads) {
+            thread.join();
+        }
+    }
+
+    unsigned int size() const {
+        return queues.size();
+    }
+
+    void submit(Task task) {
+        std::size_t queue_idx;
+        if (current_pool == this) {
+            queue_idx = current_worker;
+        } else {
+            queue_idx = next_queue++ % queues.size();
+        }
+
+        // Counted before it is published, since another worker may take and finish the task right away. Otherwise, a
+        // task submitted by a running task could decrement unfinished to 0, before the parent is finished.
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            ++queued;
+            ++unfinished;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[queue_idx]->mutex);
+            queues[queue_idx]->tasks.push_back(std::move(task));
+        }
+        work_available.notify_one();
+    }
+
+    /**
+     * Blocks until all submitted tasks are finished. Rethrows the first exception thrown by a task.
+     *
+     * \pre Must not be called from a worker of this pool.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        all_finished.wait(lock, [this] { return unfinished == 0; });
+        if (exception) {
+            std::exception_ptr e = exception;
+            exception = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    struct Queue {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> next_queue{0};
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_finished;
+    std::size_t queued = 0;
+    std::size_t unfinished = 0;
+    bool stopping = false;
+    std::exception_ptr exception;
+
+    inline static thread_local WorkStealingPool * current_pool = nullptr;
+    inline static thread_local std::size_t current_worker = 0;
+
+    bool take(std::size_t queue_idx, Task & task) {
+        Queue & queue = *queues[queue_idx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    bool next_task(std::size_t worker, Task & task) {
+        // Own queue first, afterwards steal from the other workers
+        for (std::size_t i = 0; i < queues.size(); ++i) {
+            if (take((worker + i) % queues.size(), task)) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                --queued;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(std::size_t worker) {
+        current_pool = this;
+        current_worker = worker;
+
+        while (true) {
+            Task task;
+            if (next_task(worker, task)) {
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state_mutex);
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (--unfinished == 0) {
+                    all_finished.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) {
+                return;
+            }
+        }
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_WORK_STEALING_POOL_H
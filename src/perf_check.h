@@ -0,0 +1,333 @@
+//
+// Performance regression gate: solves a fixed subset of the benchmark corpus and compares the wall times and outcomes
+// per instance against a baseline file.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_PERF_CHECK_H
+#define ANGULAR_ART_GALLERY_PROBLEM_PERF_CHECK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "benchmark_journal.h"
+
+
+namespace perf_check {
+    /**
+     * One directory per row of the benchmark table in the README, relative to the base directory.
+     */
+    static std::vector<std::string> const DEFAULT_INSTANCE_SETS = {
+            "random_small_int",
+            "random_small_float",
+            "random_large_float",
+            "AGPLIB/AGP2007",
+            "AGPLIB/AGP2008a",
+            "AGPLIB/AGP2008b",
+            "AGPLIB/AGP2009a"
+    };
+
+    struct Options {
+        std::string base_dir;
+        std::string baseline_file;
+        std::string machine;
+        std::vector<std::string> instance_sets;
+        bool update = false;
+        int instances_per_set = 4;
+        int repetitions = 5;
+        int max_size = 1000;
+        unsigned int seed = 0;
+        double alpha = 0.01;
+        double min_slowdown = 1.1;
+    };
+
+    /**
+     * The repeated wall times and the outcome of an instance, named by its path relative to the base directory.
+     */
+    struct Sample {
+        std::string instance;
+        Outcome outcome = Outcome::UNSOLVED;
+        std::vector<double> seconds;
+    };
+
+    /**
+     * Adds the options shared by all perf check tools.
+     */
+    static void add_options(boost::program_options::options_description & desc, Options & ops) {
+        namespace po = boost::program_options;
+        desc.add_options()
+                ("base_dir,b", po::value<std::string>(&ops.base_dir)->required(), "Instance base directory")
+                ("baseline", po::value<std::string>(&ops.baseline_file),
+                        "Baseline file, which is compared against or written with --update")
+                ("update", po::bool_switch(&ops.update),
+                        "Select the instances, solve them and write the baseline instead of comparing")
+                ("machine", po::value<std::string>(&ops.machine),
+                        "Description of the machine, which is written into the baseline with --update")
+                ("instance_set,i", po::value<std::vector<std::string>>(&ops.instance_sets),
+                        "Instance directories to select from with --update (default: one per row of the README table)")
+                ("count,n", po::value<int>(&ops.instances_per_set),
+                        "Number of instances selected per instance set with --update")
+                ("max_size,m", po::value<int>(&ops.max_size),
+                        "Select only instances with a size less than or equal to max size with --update")
+                ("seed,s", po::value<unsigned int>(&ops.seed), "Seed of the instance selection with --update")
+                ("repetitions,k", po::value<int>(&ops.repetitions),
+                        "Number of timed runs per instance, after one untimed warm up run")
+                ("alpha", po::value<double>(&ops.alpha), "Significance level of a slowdown")
+                ("min_slowdown", po::value<double>(&ops.min_slowdown),
+                        "Minimal ratio of the median times, which is reported as a slowdown")
+                ;
+    }
+
+    /**
+     * Selects instances_per_set instances of every instance set (including subdirectories). The instances are ordered
+     * by a stable hash of the seed and their name, such that the selection does not depend on the file system order or
+     * the platform.
+     * \throws std::runtime_error if an instance set does not exist
+     */
+    static std::vector<std::string> select_instances(Options const & options,
+            std::function<std::size_t(std::filesystem::path const &)> const & read_size) {
+        namespace fs = std::filesystem;
+        std::vector<std::string> selected;
+        for (auto const & instance_set : options.instance_sets) {
+            fs::path directory = fs::path(options.base_dir) / instance_set;
+            if (!fs::is_directory(directory)) {
+                throw std::runtime_error("Missing instance set " + directory.string());
+            }
+
+            std::vector<std::pair<std::uint64_t, std::string>> candidates;
+            for (auto const & file : fs::recursive_directory_iterator(directory)) {
+                if (!fs::is_regular_file(file) || file.path().extension() != ".pol") {
+                    continue;
+                }
+                if (options.max_size > 0 && read_size(file.path()) > (std::size_t)options.max_size) {
+                    continue;
+                }
+                std::string name = fs::relative(file.path(), options.base_dir).generic_string();
+                candidates.emplace_back(instance_hash(std::to_string(options.seed) + "/" + name), name);
+            }
+            std::sort(candidates.begin(), candidates.end());
+            for (std::size_t i = 0; i < candidates.size() && i < (std::size_t)options.instances_per_set; ++i) {
+                selected.push_back(candidates[i].second);
+            }
+        }
+        return selected;
+    }
+
+    /**
+     * Every line of a baseline is one instance: the name, the outcome and the comma separated times in seconds,
+     * separated by tabs. Lines starting with '#' are comments, which describe how the baseline was recorded.
+     */
+    static void write_baseline(std::string const & filename, std::vector<Sample> const & samples,
+            std::vector<std::string> const & comments) {
+        std::ofstream file(filename);
+        if (!file) {
+            throw std::runtime_error("Cannot write baseline " + filename);
+        }
+        for (auto const & comment : comments) {
+            file << "# " << comment << std::endl;
+        }
+        file << std::setprecision(6);
+        for (auto const & sample : samples) {
+            file << sample.instance << '\t' << outcome_name(sample.outcome) << '\t';
+            for (std::size_t i = 0; i < sample.seconds.size(); ++i) {
+                file << (i > 0 ? "," : "") << sample.seconds[i];
+            }
+            file << std::endl;
+        }
+    }
+
+    /**
+     * \throws std::runtime_error if the baseline cannot be read or has an invalid line
+     */
+    static std::vector<Sample> read_baseline(std::string const & filename) {
+        if (!std::filesystem::exists(filename)) {
+            throw std::runtime_error("Missing baseline " + filename + ", record it on the reference machine with "
+                    "--update (see perf_baseline.sh)");
+        }
+        std::ifstream file(filename);
+        if (!file) {
+            throw std::runtime_error("Cannot read baseline " + filename);
+        }
+
+        std::vector<Sample> samples;
+        std::string line;
+        for (int line_number = 1; std::getline(file, line); ++line_number) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string outcome, times;
+            Sample sample;
+            bool valid = std::getline(fields, sample.instance, '\t') && std::getline(fields, outcome, '\t')
+                    && std::getline(fields, times);
+            bool known = false;
+            for (Outcome o : {Outcome::SOLVED, Outcome::UNSOLVED, Outcome::TIMEOUT}) {
+                if (outcome == outcome_name(o)) {
+                    sample.outcome = o;
+                    known = true;
+                }
+            }
+            std::istringstream time_stream(times);
+            for (std::string time; valid && std::getline(time_stream, time, ',');) {
+                try {
+                    sample.seconds.push_back(std::stod(time));
+                } catch (std::logic_error const &) {
+                    valid = false;
+                }
+            }
+            if (!valid || !known || sample.seconds.empty()) {
+                throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": invalid baseline line");
+            }
+            samples.push_back(sample);
+        }
+        return samples;
+    }
+
+    static double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        std::size_t n = values.size();
+        return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    }
+
+    /**
+     * One-sided Mann-Whitney U test: the probability of the observed (or a larger) number of pairs, in which the
+     * current time is slower than the baseline time, if both samples come from the same distribution. Ties count half.
+     * The exact distribution of U is used, which is cheap for the small number of repetitions.
+     */
+    static double slowdown_p_value(std::vector<double> const & baseline, std::vector<double> const & current) {
+        std::size_t n = current.size();
+        std::size_t m = baseline.size();
+        double u = 0;
+        for (double c : current) {
+            for (double b : baseline) {
+                u += c > b ? 1 : (c == b ? 0.5 : 0);
+            }
+        }
+
+        // counts[j][k]: number of orderings of i current and j baseline times with U = k, built up row by row over i
+        std::vector<std::vector<double>> counts(m + 1, std::vector<double>(n * m + 1, 0));
+        for (std::size_t j = 0; j <= m; ++j) {
+            counts[j][0] = 1;
+        }
+        for (std::size_t i = 1; i <= n; ++i) {
+            std::vector<std::vector<double>> next(m + 1, std::vector<double>(n * m + 1, 0));
+            next[0][0] = 1;
+            for (std::size_t j = 1; j <= m; ++j) {
+                for (std::size_t k = 0; k <= n * m; ++k) {
+                    // The largest time is either a current time (slower than all j baseline times) or a baseline time
+                    next[j][k] = (k >= j ? counts[j][k - j] : 0) + next[j - 1][k];
+                }
+            }
+            counts = std::move(next);
+        }
+
+        double total = 0;
+        double at_least_u = 0;
+        for (std::size_t k = 0; k <= n * m; ++k) {
+            total += counts[m][k];
+            if (k >= std::ceil(u)) {
+                at_least_u += counts[m][k];
+            }
+        }
+        return at_least_u / total;
+    }
+
+    /**
+     * Solves the instance once untimed and then the given number of times, with the wall time of every run.
+     */
+    static Sample measure(Options const & options, std::string const & instance,
+            std::function<Outcome(std::filesystem::path const &)> const & solve) {
+        std::filesystem::path path = std::filesystem::path(options.base_dir) / instance;
+        Sample sample{instance, solve(path), {}};
+        for (int r = 0; r < options.repetitions; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            Outcome outcome = solve(path);
+            sample.seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            if (outcome != sample.outcome) {
+                throw std::runtime_error("Non deterministic outcome of " + instance);
+            }
+        }
+        return sample;
+    }
+
+    /**
+     * With --update, selects and solves the instances and writes the baseline. Otherwise solves the instances of the
+     * baseline and reports every instance with a changed outcome or a significant slowdown: the median time is at least
+     * min_slowdown times the baseline median and the slowdown is significant at level alpha.
+     *
+     * Returns the exit code of the tool: 0 if there is no regression, 1 otherwise.
+     * \throws std::runtime_error if the instances or the baseline cannot be read
+     */
+    static int run(Options options, std::string const & solver_name,
+            std::function<std::size_t(std::filesystem::path const &)> const & read_size,
+            std::function<Outcome(std::filesystem::path const &)> const & solve) {
+        if (options.instance_sets.empty()) {
+            options.instance_sets = DEFAULT_INSTANCE_SETS;
+        }
+        std::cout << std::fixed << std::setprecision(3);
+
+        if (options.update) {
+            std::vector<Sample> samples;
+            for (auto const & instance : select_instances(options, read_size)) {
+                samples.push_back(measure(options, instance, solve));
+                std::cout << instance << ": " << outcome_name(samples.back().outcome) << ", "
+                          << 1000 * median(samples.back().seconds) << " ms" << std::endl;
+            }
+            std::vector<std::string> comments = {solver_name + " baseline, seed " + std::to_string(options.seed) + ", "
+                    + std::to_string(options.instances_per_set) + " instances per set, max size "
+                    + std::to_string(options.max_size) + ", " + std::to_string(options.repetitions) + " repetitions"};
+            if (!options.machine.empty()) {
+                comments.push_back("Machine: " + options.machine);
+            }
+            write_baseline(options.baseline_file, samples, comments);
+            std::cout << "Wrote baseline of " << samples.size() << " instances to " << options.baseline_file
+                      << std::endl;
+            return 0;
+        }
+
+        std::vector<std::string> changed;
+        std::vector<std::string> slower;
+        double baseline_total = 0;
+        double current_total = 0;
+        for (Sample const & baseline : read_baseline(options.baseline_file)) {
+            Sample current = measure(options, baseline.instance, solve);
+            double baseline_median = median(baseline.seconds);
+            double current_median = median(current.seconds);
+            double ratio = current_median / std::max(baseline_median, 1e-9);
+            double p_value = slowdown_p_value(baseline.seconds, current.seconds);
+            baseline_total += baseline_median;
+            current_total += current_median;
+
+            std::cout << baseline.instance << ": " << 1000 * baseline_median << " ms -> " << 1000 * current_median
+                      << " ms (x" << ratio << ", p = " << p_value << ")";
+            if (current.outcome != baseline.outcome) {
+                std::cout << ", " << outcome_name(baseline.outcome) << " -> " << outcome_name(current.outcome);
+                changed.push_back(baseline.instance);
+            }
+            if (ratio >= options.min_slowdown && p_value <= options.alpha) {
+                std::cout << ", SLOWER";
+                slower.push_back(baseline.instance);
+            }
+            std::cout << std::endl;
+        }
+
+        std::cout << "Total median time: " << 1000 * baseline_total << " ms -> " << 1000 * current_total << " ms"
+                  << std::endl;
+        std::cout << "Changed outcomes: " << changed.size() << std::endl;
+        std::cout << "Significant slowdowns: " << slower.size() << std::endl;
+        return changed.empty() && slower.empty() ? 0 : 1;
+    }
+}
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_PERF_CHECK_H
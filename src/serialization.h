@@ -13,30 +13,35 @@
 
 #include <filesystem>
 #include <fstream>
-#include <regex>
+
+#include "number_parser.h"
 
 namespace fs = std::filesystem;
 
 namespace serialization {
-    template<class Kernel>
-    CGAL::Polygon_2<Kernel> read_file(fs::path const & path) {
+    /**
+     * Reads only the polygon size from the first line of an instance file, without parsing the coordinates.
+     */
+    static std::size_t read_size(fs::path const & path) {
         if (!fs::is_regular_file(path)) {
             throw std::invalid_argument("Not a file: " + path.string());
         }
 
         std::ifstream stream(path);
-        CGAL::Polygon_2<Kernel> polygon;
-
-        int size;
+        std::size_t size = 0;
         stream >> size;
+        return size;
+    }
 
-        std::string x_str, y_str;
-        while (stream >> x_str >> y_str) {
-            polygon.push_back(CGAL::Point_2<Kernel>(typename Kernel::FT(x_str), typename Kernel::FT(y_str)));
+    /**
+     * Reads an instance file with the exact number parser, see number_parser.h.
+     */
+    template<class Kernel>
+    CGAL::Polygon_2<Kernel> read_file(fs::path const & path) {
+        if (!fs::is_regular_file(path)) {
+            throw std::invalid_argument("Not a file: " + path.string());
         }
-
-        assert(polygon.size() == size);
-        return polygon;
+        return read_polygon<Kernel>(path.string());
     }
 
     /**
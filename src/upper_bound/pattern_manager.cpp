@@ -4,6 +4,10 @@
 
 #include "pattern_manager.h"
 
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
 #include "upper_bound/patterns/convex_subpolygon_pattern.h"
 #include "upper_bound/patterns/duct_pattern.h"
 #include "upper_bound/patterns/edge_extension_pattern.h"
@@ -57,4 +61,55 @@ std::vector<BasePattern*> PatternManager::get_all() {
         &convex_subpolygon_pattern,
         &edge_extension_pattern,
     };
+}
+
+std::vector<Pattern> PatternManager::default_order() {
+    return std::vector<Pattern> {
+        Pattern::SMALL_TRIANGLE,
+        Pattern::RADIUS,
+        Pattern::DUCT,
+        Pattern::HISTOGRAM,
+        Pattern::NON_CONVEX_VERTEX,
+        Pattern::CONVEX_SUBPOLYGON,
+        Pattern::EDGE_EXTENSION,
+    };
+}
+
+std::string PatternManager::name(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::CONVEX_SUBPOLYGON:
+            return "convex_subpolygon";
+        case Pattern::DUCT:
+            return "duct";
+        case Pattern::EDGE_EXTENSION:
+            return "edge_extension";
+        case Pattern::HISTOGRAM:
+            return "histogram";
+        case Pattern::NON_CONVEX_VERTEX:
+            return "non_convex_vertex";
+        case Pattern::RADIUS:
+            return "radius";
+        case Pattern::SMALL_TRIANGLE:
+            return "small_triangle";
+    }
+    return "";
+}
+
+std::vector<Pattern> PatternManager::parse(std::string const & names) {
+    std::vector<Pattern> all = default_order();
+    std::vector<Pattern> patterns;
+
+    std::stringstream stream(names);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        auto it = std::find_if(all.begin(), all.end(), [&name](Pattern p) { return PatternManager::name(p) == name; });
+        if (it == all.end()) {
+            throw std::invalid_argument("Unknown pattern: " + name);
+        }
+        if (std::find(patterns.begin(), patterns.end(), *it) != patterns.end()) {
+            throw std::invalid_argument("Repeated pattern: " + name);
+        }
+        patterns.push_back(*it);
+    }
+    return patterns;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_PATTERN_MANAGER_H
 #define ANGULAR_ART_GALLERY_PROBLEM_PATTERN_MANAGER_H
 
+#include <string>
 #include <vector>
 
 #include "patterns/base_pattern.h"
@@ -27,6 +28,22 @@ public:
     static BasePattern* get(Pattern pattern);
     static std::vector<BasePattern*> get(std::vector<Pattern> const & patterns);
     static std::vector<BasePattern*> get_all();
+
+    /**
+     * The order, in which the tools test the patterns by default.
+     */
+    static std::vector<Pattern> default_order();
+
+    /**
+     * Short name of the pattern, used on the command line and in profiles.
+     */
+    static std::string name(Pattern pattern);
+
+    /**
+     * Parses a comma separated list of pattern names.
+     * \throws std::invalid_argument for unknown or repeated names
+     */
+    static std::vector<Pattern> parse(std::string const & names);
 };
 
 #endif //ANGULAR_ART_GALLERY_PROBLEM_PATTERN_MANAGER_H
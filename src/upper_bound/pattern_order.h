@@ -0,0 +1,104 @@
+//
+// Order, in which the solver tests the patterns, chosen per polygon class from the counters of a benchmark run.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_PATTERN_ORDER_H
+#define ANGULAR_ART_GALLERY_PROBLEM_PATTERN_ORDER_H
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "pattern_manager.h"
+#include "polygon_features.h"
+
+
+/**
+ * Without a profile, all polygon classes (see PolygonFeatures) use the given order.
+ *
+ * A profile, as written by benchmark -p, contains the calls, successes and time of every pattern per polygon class.
+ * The patterns of a class are sorted by decreasing successes per time, i.e. by the chance to split the polygon per time
+ * spent. Patterns, which were never called for a class, come next, and patterns, which never succeeded, last. Ties keep
+ * the given order.
+ */
+class PatternOrder {
+public:
+    explicit PatternOrder(std::vector<Pattern> const & patterns) {
+        orders.fill(PatternManager::get(patterns));
+    }
+
+    std::vector<BasePattern*> const & get(std::size_t polygon_class) const {
+        return orders[polygon_class];
+    }
+
+    /**
+     * Reorders the patterns by the summed counters of all instance sets in the profile.
+     * \throws std::runtime_error if the profile cannot be read
+     */
+    void load_profile(std::string const & filename) {
+        namespace pt = boost::property_tree;
+
+        std::array<std::map<std::string, Counters>, PolygonFeatures::CLASSES> counters;
+        try {
+            pt::ptree profile;
+            pt::read_json(filename, profile);
+            for (auto const & instance_set : profile) {
+                auto classes = instance_set.second.get_child_optional("classes");
+                if (!classes) {
+                    continue;
+                }
+                for (auto const & polygon_class : *classes) {
+                    std::size_t c = std::stoul(polygon_class.first);
+                    if (c >= PolygonFeatures::CLASSES) {
+                        continue;
+                    }
+                    for (auto const & entry : polygon_class.second.get_child("patterns")) {
+                        Counters & pattern = counters[c][entry.second.get<std::string>("name")];
+                        pattern.calls += entry.second.get<double>("calls");
+                        pattern.successes += entry.second.get<double>("successes");
+                        pattern.milliseconds += entry.second.get<double>("milliseconds");
+                    }
+                }
+            }
+        } catch (pt::ptree_error const & e) {
+            throw std::runtime_error("Cannot read pattern profile " + filename + ": " + e.what());
+        } catch (std::logic_error const & e) {
+            throw std::runtime_error("Invalid polygon class in pattern profile " + filename);
+        }
+
+        for (std::size_t c = 0; c < PolygonFeatures::CLASSES; ++c) {
+            std::stable_sort(orders[c].begin(), orders[c].end(), [&](BasePattern * a, BasePattern * b) {
+                return score(counters[c], a) > score(counters[c], b);
+            });
+        }
+    }
+
+private:
+    struct Counters {
+        double calls = 0;
+        double successes = 0;
+        double milliseconds = 0;
+    };
+
+    std::array<std::vector<BasePattern*>, PolygonFeatures::CLASSES> orders;
+
+    static double score(std::map<std::string, Counters> const & counters, BasePattern * pattern) {
+        auto it = counters.find(PatternManager::name((Pattern)pattern->value()));
+        if (it == counters.end() || it->second.calls == 0) {
+            return 0;
+        }
+        if (it->second.successes == 0) {
+            return -1;
+        }
+        // Patterns are timed in nanoseconds, the minimum avoids the division by zero
+        return it->second.successes / std::max(it->second.milliseconds, 1e-6);
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_PATTERN_ORDER_H
@@ -0,0 +1,55 @@
+//
+// Concurrent search for the first matching split candidate of a pattern.
+//
+
+#include "base_pattern.h"
+
+#include <atomic>
+
+#include "upper_bound/visualizer.h"
+
+
+std::size_t BasePattern::find_first_success(PolygonContext & context, std::size_t n, WorkStealingPool & thread_pool,
+        PatternStatistics * statistics, CancellationToken const * cancellation) {
+    // Afterwards, the threads only read the context
+    context.build_indices();
+
+    std::atomic<std::size_t> next_candidate(0);
+    std::atomic<std::size_t> first_success(n);
+
+    for (unsigned int worker = 0; worker < thread_pool.size(); ++worker) {
+        thread_pool.submit([&] {
+            Visualizer visualizer; // Disabled, the split is executed again by the caller
+            SubpolygonContainer subpolygons;
+            std::uint64_t tested = 0;
+            std::uint64_t segment_tests = segment_inside_polygon_calls();
+
+            std::size_t i;
+            while ((i = next_candidate++) < first_success) {
+                if (cancellation && cancellation->cancelled()) {
+                    break;
+                }
+                if (inherits_failures() && skip_known_failures() && context.known_failure(i, value_)) {
+                    continue;
+                }
+
+                ++tested;
+                subpolygons.clear();
+                if (split_at(context, i, subpolygons, visualizer)) {
+                    std::size_t current = first_success;
+                    while (i < current && !first_success.compare_exchange_weak(current, i)) { }
+                    break;
+                }
+            }
+
+            if (statistics) {
+                statistics->candidates.fetch_add(tested, std::memory_order_relaxed);
+                statistics->segment_tests.fetch_add(segment_inside_polygon_calls() - segment_tests,
+                        std::memory_order_relaxed);
+            }
+        });
+    }
+    thread_pool.wait();
+
+    return first_success;
+}
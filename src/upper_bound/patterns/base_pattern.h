@@ -5,7 +5,16 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_BASE_PATTERN_H
 #define ANGULAR_ART_GALLERY_PROBLEM_BASE_PATTERN_H
 
+#include <chrono>
+#include <cstdint>
+
+#include "helpers/segment_inside_polygon.h"
+#include "helpers/split_polygon.h"
 #include "kernel_definitions.h"
+#include "parallel/cancellation_token.h"
+#include "parallel/work_stealing_pool.h"
+#include "upper_bound/polygon_context.h"
+#include "upper_bound/solver_statistics.h"
 
 
 class Visualizer; // Forward declaration to avoid circular includes
@@ -13,8 +22,51 @@ class Visualizer; // Forward declaration to avoid circular includes
 class BasePattern {
 public:
     BasePattern(int value) : value_(value) {}
-    virtual bool split(Polygon const & polygon, std::stack<Polygon const> & remaining_polygons,
-            Visualizer & visualizer) = 0;
+
+    /**
+     * Tests the split candidates (usually the polygon vertices) in order and splits the polygon at the first matching
+     * one. The resulting subpolygons (given by vertex ids) are appended to subpolygons.
+     *
+     * Candidates with a failure inherited from the parent polygon are skipped, failing candidates are recorded in the
+     * context, such that the subpolygons can inherit them.
+     *
+     * If a thread pool is given, the candidates are tested concurrently (see find_first_success). The polygon is split
+     * at the same candidate as in a serial run.
+     *
+     * If statistics are given, the call, the tested candidates, the segment inside polygon tests and the wall time are
+     * added to them.
+     *
+     * If a cancellation token is given, it is checked before every candidate. Once it is cancelled, no further
+     * candidates are tested and false is returned.
+     */
+    bool split(PolygonContext & context, SubpolygonContainer & subpolygons, Visualizer & visualizer,
+            WorkStealingPool * thread_pool = nullptr, PatternStatistics * statistics = nullptr,
+            CancellationToken const * cancellation = nullptr) {
+        if (!statistics) {
+            return split_candidates(context, subpolygons, visualizer, thread_pool, nullptr, cancellation);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t segment_tests = segment_inside_polygon_calls();
+
+        bool success = split_candidates(context, subpolygons, visualizer, thread_pool, statistics, cancellation);
+
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        statistics->calls.fetch_add(1, std::memory_order_relaxed);
+        statistics->successes.fetch_add(success, std::memory_order_relaxed);
+        statistics->segment_tests.fetch_add(segment_inside_polygon_calls() - segment_tests, std::memory_order_relaxed);
+        statistics->nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+        return success;
+    }
+
+    /**
+     * Returns true, if a failure of vertex i in the parent polygon still holds in the given subpolygon.
+     * Only called for patterns, which inherit failures.
+     */
+    virtual bool failure_inherited(PolygonContext const & subpolygon, std::size_t i) const {
+        return false;
+    }
 
     virtual bool combine_visualizations() const {
         return false;
@@ -27,8 +79,92 @@ public:
     virtual std::string description() const = 0;
 
     virtual ~BasePattern() {};
+
+protected:
+    /**
+     * Number of split candidates. Candidate i corresponds to vertex i, if not stated otherwise by the pattern.
+     */
+    virtual std::size_t candidates(Polygon const & polygon) const {
+        return polygon.size();
+    }
+
+    virtual bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) = 0;
+
+    /**
+     * Patterns, which inherit failures, record a failure for every candidate i, for which split_at returns false.
+     */
+    virtual bool inherits_failures() const {
+        return false;
+    }
+
+    /**
+     * If true, split_at may be called for several candidates concurrently, i.e. split_at only reads the context and
+     * does not add vertices to the vertex pool.
+     */
+    virtual bool concurrent_candidates() const {
+        return true;
+    }
+
+    /**
+     * If false, candidates with a known failure are passed to split_at anyway, e.g. to test only the parts of the
+     * polygon, which changed since the failure was recorded.
+     */
+    virtual bool skip_known_failures() const {
+        return true;
+    }
+
 private:
+    // Smaller polygons are not worth distributing the candidates over several threads
+    static constexpr std::size_t MIN_CONCURRENT_CANDIDATES = 32;
+
     int value_;
+
+    bool split_candidates(PolygonContext & context, SubpolygonContainer & subpolygons, Visualizer & visualizer,
+            WorkStealingPool * thread_pool, PatternStatistics * statistics, CancellationToken const * cancellation) {
+        std::size_t n = candidates(context.polygon());
+
+        // All candidates before first_success are known to fail, unless the threads were cancelled. Then, the token
+        // stays cancelled and the loop below stops before recording any failure.
+        std::size_t first_success = 0;
+        if (thread_pool && thread_pool->size() > 1 && concurrent_candidates() && n >= MIN_CONCURRENT_CANDIDATES) {
+            first_success = find_first_success(context, n, *thread_pool, statistics, cancellation);
+        }
+
+        std::uint64_t tested = 0;
+        bool success = false;
+        for (std::size_t i = 0; i < n && !success; ++i) {
+            if (cancellation && cancellation->cancelled()) {
+                break;
+            }
+            if (inherits_failures() && skip_known_failures() && context.known_failure(i, value_)) {
+                continue;
+            }
+
+            if (i >= first_success) {
+                ++tested;
+                success = split_at(context, i, subpolygons, visualizer);
+            }
+
+            if (!success && inherits_failures()) {
+                context.record_failure(i, value_);
+            }
+        }
+
+        if (statistics) {
+            statistics->candidates.fetch_add(tested, std::memory_order_relaxed);
+        }
+        return success;
+    }
+
+    /**
+     * Tests the first n candidates on the threads of the pool and returns the smallest matching one (or n, if none
+     * matches). The splits found by the threads are discarded. Once a match is found, the threads skip all larger
+     * candidates. The candidates and segment inside polygon tests of the threads are added to the statistics. The
+     * threads stop early, if the token is cancelled.
+     */
+    std::size_t find_first_success(PolygonContext & context, std::size_t n, WorkStealingPool & thread_pool,
+            PatternStatistics * statistics, CancellationToken const * cancellation);
 };
 
 #endif //ANGULAR_ART_GALLERY_PROBLEM_BASE_PATTERN_H
@@ -11,8 +11,7 @@
 #include "helpers/split_polygon.h"
 #include "non_convex_vertex_pattern.h"
 #include "upper_bound/pattern_manager.h"
-#include "upper_bound/patterns/helpers/cosine_30.h"
-#include "upper_bound/patterns/helpers/segment_inside_polygon.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
 #include "upper_bound/visualizer.h"
 
 
@@ -20,90 +19,88 @@ class ConvexSubpolygonPattern: public BasePattern {
 public:
     ConvexSubpolygonPattern(int value) : BasePattern(value) { }
 
+    bool failure_inherited(PolygonContext const & subpolygon, std::size_t i) const override {
+        // The pattern only looks at the convex polygon chain starting at vertex i, up to the first non-convex vertex
+        long last = subpolygon.next_non_convex((long)i + 2);
+        if (last - (long)i > (long)subpolygon.size() - 2) {
+            return false;
+        }
+        return subpolygon.chain_inherited(i, last + 1);
+    }
+
+    bool combine_visualizations() const override {
+        return true;
+    }
+
+    std::string description() const override {
+        return "Convex subpolygon pattern";
+    }
+
+protected:
     /**
      * \pre polygon.size() > 4
      * \pre polygon is not convex
      */
-    bool split(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-               Visualizer &visualizer) override {
-        auto start = polygon.vertices_circulator();
-        auto current = start;
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) override {
+        long current = candidate;
 
-        do {
 #ifdef DEBUG_LOG
-            std::cout << "Current vertex: " << *current << std::endl;
+        std::cout << "Current vertex: " << context.vertex(current) << std::endl;
 #endif
-            if (
-                    !CGAL::left_turn(*current, *(current + 1), *(current + 2)) ||
-                    !CGAL::left_turn(*(current + 1), *(current + 2), *(current + 3))
-            ) {
-                continue;
-            }
+        // The subpolygon is closed by a diagonal from the current vertex to a vertex on the convex chain after it, up
+        // to the first non-convex vertex. The chain has to start with two convex vertices.
+        long next_non_convex = context.next_non_convex(current);
+        if (next_non_convex <= current + 2) {
+            return false;
+        }
+        long last_end = std::min(next_non_convex, current + (long)context.size() - 2);
 
-            auto subpolygon_end = current + 3;
-            do {
-                bool success = false;
-                BasePattern* pattern_ptr = this;
-                Segment split_segment = Segment(*subpolygon_end, *current);
-                if (
-                        !CGAL::right_turn(*subpolygon_end, *current, *(current + 1)) &&
-                        !CGAL::right_turn(*(subpolygon_end - 1), *subpolygon_end, *current) &&
-                        segment_inside_polygon(polygon, split_segment)
-                ) {
-                    // all vertices are convex
-                    Polygon convex_subpolygon(current, subpolygon_end + 1);
-                    int size = convex_subpolygon.size();
-                    if (smallest_inner_angle_cos(convex_subpolygon) >= cosine_30(std::min(size - 2, 6))) {
-                        success = true;
-                    }
-                } else if (
-                        (
-                                !CGAL::right_turn(*subpolygon_end, *current, *(current + 1)) ||
-                                !CGAL::right_turn(*(subpolygon_end - 1), *subpolygon_end, *current)
-                        ) && segment_inside_polygon(polygon, split_segment)
-                ) {
-                    // exactly one vertex is non-conex. This one is one at the split segment.
-                    Polygon non_convex_subpolygon(current, subpolygon_end + 1);
-                    success = helpers::one_non_convex_vertex_subpolygon_coverable(non_convex_subpolygon);
-                    pattern_ptr = PatternManager::get(Pattern::NON_CONVEX_VERTEX);
+        for (long end = current + 3; end <= last_end; ++end) {
+            bool success = false;
+            BasePattern* pattern_ptr = this;
+            Segment split_segment = Segment(context.vertex(end), context.vertex(current));
+            bool convex_at_current = !CGAL::right_turn(context.vertex(end), context.vertex(current),
+                    context.vertex(current + 1));
+            bool convex_at_end = !CGAL::right_turn(context.vertex(end - 1), context.vertex(end),
+                    context.vertex(current));
+            if (convex_at_current && convex_at_end && context.diagonal_inside(end, candidate)) {
+                // all vertices are convex
+                int size = end - current + 1;
+                if (helpers::smallest_inner_angle_at_most_30(context, current, end, std::min(size - 2, 6))) {
+                    success = true;
                 }
+            } else if ((convex_at_current || convex_at_end) && context.diagonal_inside(end, candidate)) {
+                // exactly one vertex is non-conex. This one is one at the split segment.
+                success = helpers::one_non_convex_vertex_subpolygon_coverable(context, candidate, end);
+                pattern_ptr = PatternManager::get(Pattern::NON_CONVEX_VERTEX);
+            }
+
+            if (success) {
+                auto result = context.split(end, candidate);
+                assert(result.left.size() == 1);
 
-                if (success) {
-                    remaining_polygons.pop();
-
-                    auto result = split_polygon(polygon, subpolygon_end, current);
-                    assert(result.left.size() == 1);
-
-                    for (auto & subpolygon : result.right) {
-                        subpolygon = normalize_polygon(subpolygon);
-                        remaining_polygons.push(subpolygon);
-                    }
-
-                    visualizer.split_step(
-                            polygon,
-                            &(result.left[0]),
-                            &split_segment,
-                            nullptr,
-                            pattern_ptr
-                    );
-                    return true;
+                for (VertexIds const & subpolygon : result.right) {
+                    subpolygons.push_back(context.normalize(subpolygon));
                 }
-            } while (
-                CGAL::left_turn(*(subpolygon_end - 1), *subpolygon_end, *(subpolygon_end + 1)) &&
-                ++subpolygon_end != current - 1 // Condition is unnecessary, if precondition holds
-            );
-        } while (++current != start);
+
+                visualizer.split_step(
+                        context,
+                        &(result.left[0]),
+                        &split_segment,
+                        nullptr,
+                        pattern_ptr
+                );
+                return true;
+            }
+        }
 
         return false;
     }
 
-    bool combine_visualizations() const override {
+    bool inherits_failures() const override {
         return true;
     }
-
-    std::string description() const override {
-        return "Convex subpolygon pattern";
-    }
 };
 
 #endif //ANGULAR_ART_GALLERY_PROBLEM_CONVEX_SUBPOLYGON_PATTERN_H
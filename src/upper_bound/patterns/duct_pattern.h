@@ -7,9 +7,7 @@
 
 #include "base_pattern.h"
 #include "cgal_helpers/angle.h"
-#include "cgal_helpers/polygon_normalization.h"
-#include "upper_bound/patterns/helpers/cosine_30.h"
-#include "upper_bound/patterns/helpers/segment_inside_polygon.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
 #include "upper_bound/patterns/helpers/split_polygon.h"
 #include "upper_bound/visualizer.h"
 
@@ -18,82 +16,106 @@ class DuctPattern: public BasePattern {
 public:
     DuctPattern(int value) : BasePattern(value) { }
 
+    bool failure_inherited(PolygonContext const & subpolygon, std::size_t i) const override {
+        return subpolygon.edge_inherited(i);
+    }
+
+    std::string description() const override {
+        return "Duct pattern";
+    }
+
+protected:
     /**
+     * Candidate i is the edge from vertex i to vertex i + 1.
      * \pre polygon.size() >= 6
      */
-    bool split(Polygon const & polygon, std::stack<Polygon const> & remaining_polygons,
-               Visualizer & visualizer) override {
-        auto start = polygon.edges_circulator();
-        auto e1 = start;
-        do {
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) override {
+        Polygon const & polygon = context.polygon();
+        auto e1 = polygon.edges_circulator() + candidate;
 #ifdef DEBUG_LOG
-            std::cout << "Current edge e1: " << *e1 << std::endl;
+        std::cout << "Current edge e1: " << *e1 << std::endl;
 #endif
-            auto e2 = e1 + 3;
-            do {
+
+        // If e1 failed in the parent polygon, all pairs with another parent edge failed as well
+        bool known_failure = context.known_failure(candidate, value());
+
+        long n = polygon.size();
+        for (long offset = 3; offset <= n - 3; ++offset) {
+            if (known_failure && context.edge_inherited((long)candidate + offset)) {
+                continue;
+            }
+
+            auto e2 = e1 + offset;
 #ifdef DEBUG_LOG
-                std::cout << "Current edge e2: " << *e2 << std::endl;
+            std::cout << "Current edge e2: " << *e2 << std::endl;
 #endif
-                if (
-                        CGAL::collinear(e1->source(), e1->target(), e2->source()) ||
-                        CGAL::collinear(e1->source(), e1->target(), e2->target())) {
-                    continue;
-                }
+            // If both split segments are inside and the quadrilateral e1, e2 is convex, it lies inside the polygon and
+            // is thus oriented counterclockwise like the polygon. So e2 lies strictly left of e1 (which also excludes
+            // collinear edges) and the quadrilateral turns left or straight at e2. These orientation tests reject most
+            // edge pairs before any segment test.
+            if (
+                    !CGAL::left_turn(e1->source(), e1->target(), e2->source()) ||
+                    !CGAL::left_turn(e1->source(), e1->target(), e2->target()) ||
+                    CGAL::right_turn(e1->target(), e2->source(), e2->target()) ||
+                    CGAL::right_turn(e2->source(), e2->target(), e1->source())) {
+                continue;
+            }
+
+            auto split_seg_1 = Segment(e1->target(), e2->source());
+            auto split_seg_2 = Segment(e2->target(), e1->source());
+
+            if (
+                    context.diagonal_inside((long)candidate + 1, (long)candidate + offset) &&
+                    context.diagonal_inside((long)candidate + offset + 1, candidate)
+                    ) {
+                Polygon quadrilateral;
+                quadrilateral.push_back(e1->source());
+                quadrilateral.push_back(e1->target());
+                quadrilateral.push_back(e2->source());
+                quadrilateral.push_back(e2->target());
+                if (quadrilateral.is_convex() && quadrilateral_30_deg_coverable(quadrilateral)) {
+                    auto result = context.split((long)candidate + 1, (long)candidate + offset);
+
+                    for (VertexIds const & subpolygon : result.right) {
+                        subpolygons.push_back(context.normalize(subpolygon));
+                    }
 
-                auto split_seg_1 = Segment(e1->target(), e2->source());
-                auto split_seg_2 = Segment(e2->target(), e1->source());
-
-                if (
-                        segment_inside_polygon(polygon, split_seg_1) &&
-                        segment_inside_polygon(polygon, split_seg_2)
-                        ) {
-                    Polygon quadrilateral;
-                    quadrilateral.push_back(e1->source());
-                    quadrilateral.push_back(e1->target());
-                    quadrilateral.push_back(e2->source());
-                    quadrilateral.push_back(e2->target());
-                    if (quadrilateral.is_convex() && quadrilateral_30_deg_coverable(quadrilateral)) {
-                          remaining_polygons.pop();
-
-                        auto result = split_polygon(polygon, e1->target(), e2->source());
-
-                        for (Polygon &subpolygon : result.right) {
-                            subpolygon = normalize_polygon(subpolygon);
-                            remaining_polygons.push(subpolygon);
-                        }
-
-                        assert(result.left.size() == 1);
-                        auto result_2 = split_polygon(result.left[0], e2->target(), e1->source());
-                        assert(result_2.left.size() == 1 && result_2.left[0].size() == 4);
-                        for (Polygon &subpolygon : result_2.right) {
-                            subpolygon = normalize_polygon(subpolygon);
-                            remaining_polygons.push(subpolygon);
-                        }
-
-                        visualizer.split_step(
-                                polygon,
-                                &(result_2.left[0]),
-                                &split_seg_1,
-                                &split_seg_2,
-                                this
-                        );
-                        return true;
+                    assert(result.left.size() == 1);
+                    auto const & ids = context.vertex_ids();
+                    auto result_2 = context.split(result.left[0], ids[context.index((long)candidate + offset + 1)],
+                            ids[candidate]);
+                    assert(result_2.left.size() == 1 && result_2.left[0].size() == 4);
+                    for (VertexIds const & subpolygon : result_2.right) {
+                        subpolygons.push_back(context.normalize(subpolygon));
                     }
+
+                    visualizer.split_step(
+                            context,
+                            &(result_2.left[0]),
+                            &split_seg_1,
+                            &split_seg_2,
+                            this
+                    );
+                    return true;
                 }
-            } while (++e2 != e1 - 2);
-        } while (++e1 != start);
+            }
+        }
 
         return false;
     }
 
-    std::string description() const override {
-        return "Duct pattern";
+    bool inherits_failures() const override {
+        return true;
+    }
+
+    bool skip_known_failures() const override {
+        return false;
     }
 
 private:
     static bool quadrilateral_30_deg_coverable(Polygon const & quadrilateral) {
-        auto smallest_angle_cos = smallest_inner_angle_cos(quadrilateral);
-        if (smallest_angle_cos >= cosine_30(1)) {
+        if (helpers::smallest_inner_angle_at_most_30(quadrilateral, 1)) {
             return true;
         }
 
@@ -111,16 +133,11 @@ private:
         auto diagonal_angle_7 = Angle(*p2, *p4, *p1);
         auto diagonal_angle_8 = Angle(*p3, *p1, *p2);
 
-        auto check_angles = [](auto const & a, auto const & b)
-        {
-            return (a.interval() + b.interval()).upper() < (ia::pi() / ia::DoubleInterval(6)).lower();
-        };
-
         return
-            check_angles(diagonal_angle_1, diagonal_angle_3) ||
-            check_angles(diagonal_angle_2, diagonal_angle_4) ||
-            check_angles(diagonal_angle_5, diagonal_angle_7) ||
-            check_angles(diagonal_angle_6, diagonal_angle_8);
+            helpers::angle_sum_smaller_than_30(diagonal_angle_1, diagonal_angle_3) ||
+            helpers::angle_sum_smaller_than_30(diagonal_angle_2, diagonal_angle_4) ||
+            helpers::angle_sum_smaller_than_30(diagonal_angle_5, diagonal_angle_7) ||
+            helpers::angle_sum_smaller_than_30(diagonal_angle_6, diagonal_angle_8);
     }
 };
 
@@ -8,7 +8,7 @@
 #include "base_pattern.h"
 #include "cgal_helpers/angle.h"
 #include "helpers/edge_extension_helpers.h"
-#include "upper_bound/patterns/helpers/cosine_30.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
 #include "upper_bound/visualizer.h"
 
 
@@ -16,92 +16,92 @@ class EdgeExtensionPattern : public BasePattern {
 public:
     EdgeExtensionPattern(int value) : BasePattern(value) { }
 
-    bool split(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-               Visualizer &visualizer) override {
-        if (check_forward_direction(polygon, remaining_polygons, visualizer)) {
-            return true;
-        }
-
-        return check_backward_direction(polygon, remaining_polygons, visualizer);
-    }
-
     std::string description() const override {
         return "Edge extension pattern";
     }
-private:
-    bool check_forward_direction(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-            Visualizer &visualizer) {
-        return check_one_direction(polygon, remaining_polygons, visualizer, false);
+protected:
+    /**
+     * The intersection points are added to the vertex pool.
+     */
+    bool concurrent_candidates() const override {
+        return false;
     }
 
-    bool check_backward_direction(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-            Visualizer &visualizer) {
-        return check_one_direction(polygon, remaining_polygons, visualizer, true);
+    /**
+     * Candidates 0, ..., n - 1 extend the edge ending at vertex i forwards, candidates n, ..., 2n - 1 extend the edge
+     * starting at vertex i - n backwards.
+     */
+    std::size_t candidates(Polygon const & polygon) const override {
+        return 2 * polygon.size();
     }
 
-    bool check_one_direction(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-            Visualizer &visualizer, bool reverse = false) {
-        auto start = polygon.vertices_circulator();
-        auto current = start;
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) override {
+        std::size_t n = context.size();
+        if (candidate < n) {
+            return check_one_direction(context, candidate, subpolygons, visualizer, false);
+        }
+        return check_one_direction(context, candidate - n, subpolygons, visualizer, true);
+    }
 
+private:
+    bool check_one_direction(PolygonContext &context, std::size_t vertex, SubpolygonContainer &subpolygons,
+            Visualizer &visualizer, bool reverse = false) {
+        long current = vertex;
         int direction = reverse ? -1 : 1;
 
-        do {
 #ifdef DEBUG_LOG
-            std::cout << "Current vertex: " << *current << std::endl;
+        std::cout << "Current vertex: " << context.vertex(current) << std::endl;
 #endif
 
-            if (!CGAL::right_turn(*(current - 1), *current, *(current + 1))) {
-                continue;
-            }
-
-            auto result = helpers::ray_polygon_intersection(polygon, Ray(*current, *current - *(current - direction)));
+        if (!CGAL::right_turn(context.vertex(current - 1), context.vertex(current), context.vertex(current + 1))) {
+            return false;
+        }
 
-            if (!std::get<0>(result)) {
-                continue;
-            }
+        auto hit = helpers::first_boundary_hit(context, current,
+                context.vertex(current) - context.vertex(current - direction));
+        assert(hit.found);
+
+        // The subpolygon is the chain from the current vertex to the hit edge, closed by the hit point, if it is no
+        // vertex. The remaining polygon is the rest of the chain.
+        long end;
+        VertexIds subpolygon_ids;
+        if (reverse) {
+            end = hit.vertex >= 0 ? hit.vertex : hit.edge + 1;
+            subpolygon_ids = context.chain(end, current);
+        } else {
+            end = hit.vertex >= 0 ? hit.vertex : hit.edge;
+            subpolygon_ids = context.chain(current, end);
+        }
+        Polygon subpolygon = context.to_polygon(subpolygon_ids);
+        if (hit.vertex < 0) {
+            subpolygon.push_back(hit.point);
+        }
 
-            Polygon::Vertex_const_circulator subpolygon_end;
-            Polygon subpolygon;
-            if (reverse) {
-                subpolygon_end = helpers::find_vertex_circulator(polygon, std::get<1>(result)->target());
-                subpolygon = Polygon(subpolygon_end, current + 1);
+        if (
+                subpolygon.is_convex() &&
+                helpers::smallest_inner_angle_at_most_30(subpolygon, std::min((int)subpolygon.size() - 2, 6))
+                ) {
+            VertexIds remaining_polygon;
+            if (hit.vertex >= 0) {
+                remaining_polygon = reverse ? context.chain(current + 1, end) : context.chain(end, current - 1);
             } else {
-                subpolygon_end = helpers::find_vertex_circulator(polygon, std::get<1>(result)->source());
-                subpolygon = Polygon(current, subpolygon_end + 1);
+                remaining_polygon = reverse ? context.chain(current + 1, end - 1) : context.chain(end + 1, current - 1);
+                remaining_polygon.push_back(context.add_vertex(hit.point));
             }
-            subpolygon.push_back(std::get<2>(result));
-
-            if (
-                    subpolygon.is_convex() &&
-                    smallest_inner_angle_cos(subpolygon) >= cosine_30(std::min((int)subpolygon.size() - 2, 6))
-                    ) {
-                remaining_polygons.pop();
-
-                Polygon remaining_polygon;
-                if (reverse) {
-                    remaining_polygon = Polygon(current + 1, subpolygon_end);
-                } else {
-                    remaining_polygon = Polygon(subpolygon_end + 1, current);
-                }
-                remaining_polygon.push_back(std::get<2>(result));
-                remaining_polygon = normalize_polygon(remaining_polygon);
-                remaining_polygons.push(remaining_polygon);
-
-                remaining_polygon.push_back(std::get<2>(result));
-
-                Segment split_seg(*current, std::get<2>(result));
-                visualizer.split_step(
-                        polygon,
-                        &subpolygon,
-                        &split_seg,
-                        nullptr,
-                        this
-                );
-
-                return true;
-            }
-        } while (++current != start);
+            subpolygons.push_back(context.normalize(remaining_polygon));
+
+            Segment split_seg(context.vertex(current), hit.point);
+            visualizer.split_step(
+                    context.polygon(),
+                    &subpolygon,
+                    &split_seg,
+                    nullptr,
+                    this
+            );
+
+            return true;
+        }
         return false;
     }
 };
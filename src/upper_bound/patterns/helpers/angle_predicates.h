@@ -0,0 +1,125 @@
+//
+// Filtered angle predicates. The exact (squared) cosines are only computed, if interval arithmetic cannot decide the
+// predicate. No square roots are needed, such that the predicates work with any exact kernel.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_ANGLE_PREDICATES_H
+#define ANGULAR_ART_GALLERY_PROBLEM_ANGLE_PREDICATES_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "cgal_helpers/angle.h"
+#include "cgal_helpers/interval_arithmetic.h"
+#include "cosine_30.h"
+#include "kernel_definitions.h"
+
+
+/**
+ * Counts the evaluated angle predicates and how many of them needed the exact fallback.
+ */
+struct AnglePredicateStatistics {
+    std::atomic<std::uint64_t> evaluations{0};
+    std::atomic<std::uint64_t> exact_evaluations{0};
+
+    void count(bool exact) {
+        evaluations.fetch_add(1, std::memory_order_relaxed);
+        if (exact) {
+            exact_evaluations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace helpers {
+    /**
+     * Statistics of all angle predicates of the process. Inline instead of static, such that all translation units
+     * share the same counters.
+     */
+    inline AnglePredicateStatistics & angle_predicate_statistics() {
+        static AnglePredicateStatistics statistics;
+        return statistics;
+    }
+
+    /**
+     * Exact version of angle_at_most_30. Both cosines are compared by their signs and squares.
+     */
+    static bool exact_angle_at_most_30(Angle<Kernel> const & angle, int k) {
+        CGAL::Sign sign = angle.cosine_sign();
+        int threshold_sign = cosine_30_sign(k);
+        if (threshold_sign == 0) {
+            return sign != CGAL::NEGATIVE;
+        }
+        if (threshold_sign > 0) {
+            return sign == CGAL::POSITIVE && angle.squared_cosine() >= squared_cosine_30(k);
+        }
+        return sign != CGAL::NEGATIVE || angle.squared_cosine() <= squared_cosine_30(k);
+    }
+
+    /**
+     * Returns true, iff the cosine of the angle is at least the cosine of k * pi/6, i.e. the angle is at most k * pi/6
+     * for 0 <= k <= 6.
+     */
+    static bool angle_at_most_30(Angle<Kernel> const & angle, int k) {
+        ia::DoubleInterval cosine = angle.approximate_cosine();
+        ia::DoubleInterval threshold = cosine_30_interval(k);
+        if (cosine.lower() >= threshold.upper()) {
+            angle_predicate_statistics().count(false);
+            return true;
+        }
+        if (cosine.upper() < threshold.lower()) {
+            angle_predicate_statistics().count(false);
+            return false;
+        }
+
+        angle_predicate_statistics().count(true);
+        return exact_angle_at_most_30(angle, k);
+    }
+
+    /**
+     * Equivalent to smallest_inner_angle_cos(polygon) >= cos(k * pi/6), but stops at the first small enough angle and
+     * needs no sqrt. Since smallest_inner_angle_cos is never negative, this is always true for 3 <= k <= 6.
+     *
+     * \pre Polygon is counterclockwise oriented.
+     * \pre 0 <= k <= 6
+     */
+    static bool smallest_inner_angle_at_most_30(Polygon const & polygon, int k) {
+        if (k >= 3) {
+            return true;
+        }
+
+        auto start = polygon.vertices_circulator();
+        auto current = start;
+        do {
+            auto angle = Angle<Kernel>(current);
+            if (angle.is_convex() && angle_at_most_30(angle, k)) {
+                return true;
+            }
+        } while (++current != start);
+
+        return false;
+    }
+
+    /**
+     * Returns true, iff the sum of the angles a and b is smaller than pi/6, evaluated with interval arithmetic
+     * (see pitfalls in the README). The intervals of the exact squared cosines are only computed, if the approximate
+     * intervals are not sufficient.
+     */
+    static bool angle_sum_smaller_than_30(Angle<Kernel> const & a, Angle<Kernel> const & b) {
+        double bound = (ia::pi() / ia::DoubleInterval(6)).lower();
+
+        ia::DoubleInterval approximate_sum = a.approximate_interval() + b.approximate_interval();
+        if (approximate_sum.upper() < bound) {
+            angle_predicate_statistics().count(false);
+            return true;
+        }
+        if (approximate_sum.lower() >= bound) {
+            angle_predicate_statistics().count(false);
+            return false;
+        }
+
+        angle_predicate_statistics().count(true);
+        return (a.interval() + b.interval()).upper() < bound;
+    }
+}
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_ANGLE_PREDICATES_H
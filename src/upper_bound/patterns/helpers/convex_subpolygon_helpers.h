@@ -7,57 +7,78 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_CONVEX_SUBPOLYGON_HELPERS_H
 #define ANGULAR_ART_GALLERY_PROBLEM_CONVEX_SUBPOLYGON_HELPERS_H
 
-#include "cosine_30.h"
+#include "angle_predicates.h"
 #include "kernel_definitions.h"
-#include "segment_inside_polygon.h"
+#include "upper_bound/polygon_context.h"
 
 
 namespace helpers {
-    Polygon::Vertex_const_circulator
-    static find_nearest_non_convex_vertices(Polygon::Vertex_const_circulator const &v, bool reverse = false) {
-        int direction = reverse ? -1 : 1;
-        auto current = v + direction;
-        while (CGAL::left_turn(*(current - 1), *current, *(current + 1))) {
-            current += direction;
+    /**
+     * Equivalent to smallest_inner_angle_at_most_30 of the subpolygon given by the polygon chain from vertex first to
+     * vertex last, without building it. Only the angles at first and last differ from the angles of the polygon.
+     *
+     * \pre 0 <= k <= 6
+     */
+    static bool smallest_inner_angle_at_most_30(PolygonContext const & context, long first, long last, int k) {
+        if (k >= 3) {
+            return true;
         }
-        return current;
+
+        int size = context.index(last - first) + 1;
+        for (long i = 0; i < size; ++i) {
+            auto angle = Angle<Kernel>(
+                    context.vertex(i == 0 ? last : first + i - 1),
+                    context.vertex(first + i),
+                    context.vertex(i == size - 1 ? first : first + i + 1)
+            );
+            if (angle.is_convex() && angle_at_most_30(angle, k)) {
+                return true;
+            }
+        }
+
+        return false;
     }
 
-    static bool one_non_convex_vertex_subpolygon_coverable(Polygon const & split_candidate) {
-        int size = split_candidate.size();
-        assert(split_candidate.size() > 3);
-        auto floodlight_candidates_start = split_candidate.vertices_circulator();
-        auto floodlight_candidate = floodlight_candidates_start;
+    /**
+     * Tests the subpolygon given by the polygon chain from vertex first to vertex last, which is cut off by a segment
+     * inside the polygon. The visibility is looked up in the context.
+     */
+    static bool one_non_convex_vertex_subpolygon_coverable(PolygonContext const & context, long first, long last) {
+        int size = context.index(last - first) + 1;
+        assert(size > 3);
+        auto subpolygon_vertex = [&](long k) {
+            return first + ((k % size) + size) % size;
+        };
 
 #ifdef DEBUG_LOG
         std::cout << "Test if subpolygon with one non-convex subpolygon is coverable" << std::endl;
-        std::cout << "Subpolygon: " << split_candidate << std::endl;
+        std::cout << "Subpolygon: " << context.to_polygon(context.chain(first, last)) << std::endl;
 #endif
 
-        do {
+        for (long floodlight_candidate = 0; floodlight_candidate < size; ++floodlight_candidate) {
+            long floodlight = subpolygon_vertex(floodlight_candidate);
 #ifdef DEBUG_LOG
-            std::cout << "Floodlight candidate: " << *floodlight_candidate << std::endl;
+            std::cout << "Floodlight candidate: " << context.vertex(floodlight) << std::endl;
 #endif
-            auto angle = Angle<Kernel>(floodlight_candidate);
-            if (angle.is_convex() and angle.cosine() >= cosine_30(std::min(size - 2, 6))) {
+            auto angle = Angle<Kernel>(
+                    context.vertex(subpolygon_vertex(floodlight_candidate - 1)),
+                    context.vertex(floodlight),
+                    context.vertex(subpolygon_vertex(floodlight_candidate + 1))
+            );
+            if (angle.is_convex() and angle_at_most_30(angle, std::min(size - 2, 6))) {
                 bool all_visible = true;
-                auto visibiliy_vertex = floodlight_candidate + 2;
-                do {
-                    if (
-                            !segment_inside_polygon(
-                                    split_candidate,
-                                    Segment(*floodlight_candidate, *visibiliy_vertex)
-                            )
-                            ) {
+                for (long visibility_vertex = 2; all_visible && visibility_vertex < size - 1; ++visibility_vertex) {
+                    long target = subpolygon_vertex(floodlight_candidate + visibility_vertex);
+                    if (!context.diagonal_inside(floodlight, target)) {
                         all_visible = false;
                     }
-                } while (all_visible && ++visibiliy_vertex != floodlight_candidate - 1);
+                }
 
                 if (all_visible) {
                     return true;
                 }
             }
-        } while (++floodlight_candidate != floodlight_candidates_start);
+        }
 
         return false;
     }
@@ -1,5 +1,5 @@
 //
-// Returns the cosine of a multiple of pi/6.
+// Returns the cosine of a multiple of pi/6, either as interval or squared (exact).
 //
 // Created by Yannic Lieder on 02.08.20.
 //
@@ -7,24 +7,57 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_COSINE_30_H
 #define ANGULAR_ART_GALLERY_PROBLEM_COSINE_30_H
 
+#include "cgal_helpers/interval_arithmetic.h"
 #include "kernel_definitions.h"
 
 
-FT cosine_30(int k) {
-    int sign = k % 12 < 4 || k % 12 > 8 ? 1 : -1;
+/**
+ * Returns the sign of the cosine of k * pi/6.
+ */
+static int cosine_30_sign(int k) {
+    if (k % 6 == 3) {
+        return 0;
+    }
+    return k % 12 < 4 || k % 12 > 8 ? 1 : -1;
+}
+
+/**
+ * Returns the squared cosine of k * pi/6, which is rational (in contrast to the cosine itself).
+ */
+static FT squared_cosine_30(int k) {
     switch (k % 6) {
         case 0: // 0°, 180°
-            return FT(1) * sign;
+            return FT(1);
         case 1: // 30°
         case 5: // 150°
-            return CGAL::sqrt(FT(3)) / 2 * sign;
+            return FT(3) / 4;
         case 2: // 60°
         case 4: // 120°
-            return FT(1) / 2 * sign;
+            return FT(1) / 4;
         case 3: // 90°
         default:
             return FT(0);
     }
 }
 
+/**
+ * Returns an interval containing the cosine of k * pi/6.
+ */
+static ia::DoubleInterval cosine_30_interval(int k) {
+    int sign = cosine_30_sign(k);
+    switch (k % 6) {
+        case 0: // 0°, 180°
+            return ia::DoubleInterval(sign);
+        case 1: // 30°
+        case 5: // 150°
+            return ia::sqrt(ia::DoubleInterval(3)) / ia::DoubleInterval(2) * ia::DoubleInterval(sign);
+        case 2: // 60°
+        case 4: // 120°
+            return ia::DoubleInterval(0.5 * sign);
+        case 3: // 90°
+        default:
+            return ia::DoubleInterval(0);
+    }
+}
+
 #endif //ANGULAR_ART_GALLERY_PROBLEM_COSINE_30_H
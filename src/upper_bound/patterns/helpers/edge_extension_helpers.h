@@ -8,61 +8,76 @@
 #define ANGULAR_ART_GALLERY_PROBLEM_EDGE_EXTENSION_HELPERS_H
 
 #include "kernel_definitions.h"
+#include "upper_bound/polygon_context.h"
 
 
 namespace helpers {
-    static std::tuple<bool, Polygon::Edge_const_circulator, Point>
-    ray_polygon_intersection(Polygon const &polygon, Ray const &ray) {
-        auto start = polygon.edges_circulator();
-        auto current = start;
+    /**
+     * The first point of the polygon boundary on a ray.
+     */
+    struct RayHit {
+        bool found = false;
+        // The hit edge from vertex edge to vertex edge + 1
+        long edge = 0;
+        // The hit vertex, or -1, if the ray hits the interior of the edge
+        long vertex = -1;
+        Point point;
+    };
 
-        Polygon::Edge_const_circulator nearest_edge;
-        Kernel::FT smallest_squared_distance(0);
-        Point intersection_point;
-        bool found_intersection = false;
+    /**
+     * Returns the first point of the polygon boundary (besides vertex i) on the ray from vertex i in the given
+     * direction. If the ray touches a vertex or runs along an edge first, the hit is the vertex.
+     *
+     * Only the edges near the ray before the nearest hit so far are taken from the edge grid and tested with
+     * predicates. An intersection point is only constructed for an edge, which is hit before the nearest hit so far.
+     */
+    static RayHit first_boundary_hit(PolygonContext const & context, long i, Vector const & direction) {
+        std::size_t n = context.size();
+        std::size_t source = context.index(i);
+        Ray ray(context.vertex(i), direction);
 
-        do {
-            auto result = CGAL::intersection(*current, ray);
-
-            if (!result) {
-                // no intersection with current edge
-                continue;
+        RayHit hit;
+        // Contains the part of the ray before the nearest hit so far
+        CGAL::Bbox_2 limit = context.edge_grid().bbox();
+        context.edge_grid().find_edge(ray, limit, [&](std::size_t e) {
+            // The edges at vertex i touch the ray only in its source
+            if (e == source || (e + 1) % n == source) {
+                return false;
+            }
+            Segment edge(context.vertex(e), context.vertex(e + 1));
+            if (hit.found ? !CGAL::do_intersect(edge, Segment(ray.source(), hit.point))
+                          : !CGAL::do_intersect(edge, ray)) {
+                return false;
             }
-            if (const CGAL::Point_2<Kernel> *p = boost::get<CGAL::Point_2<Kernel>>(&*result)) {
-                // Intersect in one point
-                if (*p == current->source() || *p == current->target()) {
-                    // Intersection is an endpoint of the segment
-                    // TODO
-                    continue;
-                }
-
-                auto squared_distance = (ray.source() - *p).squared_length();
 
-                if (squared_distance > 0 && (!found_intersection || smallest_squared_distance > squared_distance)) {
-                    nearest_edge = current;
-                    smallest_squared_distance = squared_distance;
-                    intersection_point = *p;
-                    found_intersection = true;
-                }
+            // An edge along the ray is hit first at its nearer vertex
+            RayHit edge_hit{true, (long)e, -1, Point()};
+            bool source_hit = ray.has_on(edge.source());
+            bool target_hit = ray.has_on(edge.target());
+            if (source_hit && (!target_hit ||
+                    CGAL::has_smaller_distance_to_point(ray.source(), edge.source(), edge.target()))) {
+                edge_hit.vertex = e;
+                edge_hit.point = edge.source();
+            } else if (target_hit) {
+                edge_hit.vertex = (e + 1) % n;
+                edge_hit.point = edge.target();
             } else {
-                // TODO
-                continue;
+                // Empty only with inexact constructions, if the edge just touches the ray in a vertex hit before
+                auto result = CGAL::intersection(edge, ray);
+                Point const * point = result ? boost::get<Point>(&*result) : nullptr;
+                if (point == nullptr) {
+                    return false;
+                }
+                edge_hit.point = *point;
             }
-        } while (++current != start);
-        return std::make_tuple(found_intersection, nearest_edge, intersection_point);
-    }
-
-    static Polygon::Vertex_circulator find_vertex_circulator(Polygon const & polygon, Point const & v) {
-        auto start = polygon.vertices_circulator();
-        auto current = start;
 
-        do {
-            if (*current == v) {
-                return current;
+            if (!hit.found || CGAL::has_smaller_distance_to_point(ray.source(), edge_hit.point, hit.point)) {
+                hit = edge_hit;
+                limit = ray.source().bbox() + hit.point.bbox();
             }
-        } while (++current != start);
-        assert(false);
-        return Polygon::Vertex_circulator();
+            return false;
+        });
+        return hit;
     }
 }
 
@@ -7,12 +7,24 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_SEGMENT_INSIDE_POLYGON_H
 #define ANGULAR_ART_GALLERY_PROBLEM_SEGMENT_INSIDE_POLYGON_H
 
+#include <cstdint>
+
 #include <CGAL/intersection_2.h>
 #include <CGAL/Kernel/global_functions_2.h>
 #include <CGAL/Point_2.h>
 #include <CGAL/Polygon_2.h>
 #include <CGAL/Polygon_2_algorithms.h>
 
+#include "cgal_helpers/edge_grid.h"
+
+
+/**
+ * Number of segment inside polygon tests evaluated by the current thread, for profiling.
+ */
+inline std::uint64_t & segment_inside_polygon_calls() {
+    static thread_local std::uint64_t calls = 0;
+    return calls;
+}
 
 /**
  * Returns the direction of the Segment defined by the points source and target.
@@ -34,84 +46,97 @@ bool counterclockwise_in_between_or_equal(
     return d == d1 || d == d2 || d.counterclockwise_in_between(d1, d2);
 }
 
+enum class SegmentEdgeRelation {
+    NONE,     // The edge does not decide, whether the segment is inside the polygon
+    ON_EDGE,  // The segment lies completely on the edge
+    CROSSING  // The segment crosses the polygon boundary at the edge
+};
+
 /**
- * Returns true, iff the segment is inside the polygon (or on its boundary).
+ * Classifies the intersection of the segment with a single polygon edge.
  */
 template<class Kernel>
-bool segment_inside_polygon(CGAL::Polygon_2<Kernel> const &polygon, CGAL::Segment_2<Kernel> const &segment) {
-    auto start = polygon.edges_circulator();
-    auto current_edge = start;
-    do {
-        auto result = CGAL::intersection(*current_edge, segment);
+SegmentEdgeRelation segment_edge_relation(
+        typename CGAL::Polygon_2<Kernel>::Edge_const_circulator const & current_edge,
+        CGAL::Segment_2<Kernel> const &segment
+) {
+    auto result = CGAL::intersection(*current_edge, segment);
 
-        if (!result) {
-            // no intersection with current edge
-            continue;
+    if (!result) {
+        // no intersection with current edge
+        return SegmentEdgeRelation::NONE;
+    }
+    if (const CGAL::Point_2<Kernel> *p = boost::get<CGAL::Point_2<Kernel>>(&*result)) {
+        // Intersect in one point
+        if (*p == segment.source() || *p == segment.target()) {
+            // Intersection is an endpoint of the segment
+            return SegmentEdgeRelation::NONE;
         }
-        if (const CGAL::Point_2<Kernel> *p = boost::get<CGAL::Point_2<Kernel>>(&*result)) {
-            // Intersect in one point
-            if (*p == segment.source() || *p == segment.target()) {
-                // Intersection is an endpoint of the segment
-                continue;
-            }
-
-            CGAL::Direction_2<Kernel> d1, d2;
-            if (*p == current_edge->target()) {
-                auto next_edge = current_edge + 1;
-                d1 = direction(next_edge->source(), next_edge->target());
-                d2 = direction(current_edge->target(), current_edge->source());
-            } else if (*p == current_edge->source()) {
-                auto prev_edge = current_edge - 1;
-                d1 = direction(current_edge->source(), current_edge->target());
-                d2 = direction(prev_edge->target(), prev_edge->source());
-            } else {
-                // Intersection point is neither endpoint of the current edge nor the segment ('real' intersection)
-                return false;
-            }
-
-            // Intersects current edge at an endpoint. Check if segment just touches the vertex or intersects it
-            if (
-                    counterclockwise_in_between_or_equal(direction(*p, segment.source()), d1, d2) &&
-                    counterclockwise_in_between_or_equal(direction(*p, segment.target()), d1, d2)
-                    ) {
-                // Segment only touches the boundary
-                continue;
-            }
-            // Segment intersects the boundary
-            return false;
+
+        CGAL::Direction_2<Kernel> d1, d2;
+        if (*p == current_edge->target()) {
+            auto next_edge = current_edge + 1;
+            d1 = direction(next_edge->source(), next_edge->target());
+            d2 = direction(current_edge->target(), current_edge->source());
+        } else if (*p == current_edge->source()) {
+            auto prev_edge = current_edge - 1;
+            d1 = direction(current_edge->source(), current_edge->target());
+            d2 = direction(prev_edge->target(), prev_edge->source());
         } else {
-            // Segment is part of current edge
-            if (current_edge->has_on(segment.source()) and current_edge->has_on(segment.target())) {
-                // Segment lies completely on current edge
-                return true;
-            }
-
-            CGAL::Point_2<Kernel> const *s_source;
-            CGAL::Point_2<Kernel> const *s_target;
-            if (current_edge->direction() == segment.direction()) {
-                s_source = &segment.source();
-                s_target = &segment.target();
-            } else {
-                s_source = &segment.target();
-                s_target = &segment.source();
-            }
-
-            if (
-                    !current_edge->has_on(*s_source) and
-                    !CGAL::right_turn((current_edge - 1)->source(), current_edge->source(), current_edge->target())
-                    ) {
-                return false;
-            }
+            // Intersection point is neither endpoint of the current edge nor the segment ('real' intersection)
+            return SegmentEdgeRelation::CROSSING;
+        }
 
-            if (
-                    !current_edge->has_on(*s_target) and
-                    !CGAL::right_turn(current_edge->source(), current_edge->target(), (current_edge + 1)->target())
-                    ) {
-                return false;
-            }
+        // Intersects current edge at an endpoint. Check if segment just touches the vertex or intersects it
+        if (
+                counterclockwise_in_between_or_equal(direction(*p, segment.source()), d1, d2) &&
+                counterclockwise_in_between_or_equal(direction(*p, segment.target()), d1, d2)
+                ) {
+            // Segment only touches the boundary
+            return SegmentEdgeRelation::NONE;
+        }
+        // Segment intersects the boundary
+        return SegmentEdgeRelation::CROSSING;
+    } else {
+        // Segment is part of current edge
+        if (current_edge->has_on(segment.source()) and current_edge->has_on(segment.target())) {
+            // Segment lies completely on current edge
+            return SegmentEdgeRelation::ON_EDGE;
+        }
+
+        CGAL::Point_2<Kernel> const *s_source;
+        CGAL::Point_2<Kernel> const *s_target;
+        if (current_edge->direction() == segment.direction()) {
+            s_source = &segment.source();
+            s_target = &segment.target();
+        } else {
+            s_source = &segment.target();
+            s_target = &segment.source();
         }
-    } while (++current_edge != start);
 
+        if (
+                !current_edge->has_on(*s_source) and
+                !CGAL::right_turn((current_edge - 1)->source(), current_edge->source(), current_edge->target())
+                ) {
+            return SegmentEdgeRelation::CROSSING;
+        }
+
+        if (
+                !current_edge->has_on(*s_target) and
+                !CGAL::right_turn(current_edge->source(), current_edge->target(), (current_edge + 1)->target())
+                ) {
+            return SegmentEdgeRelation::CROSSING;
+        }
+    }
+
+    return SegmentEdgeRelation::NONE;
+}
+
+/**
+ * Point in polygon test for the segment center. Only valid, if the segment does not cross the polygon boundary.
+ */
+template<class Kernel>
+bool segment_center_inside_polygon(CGAL::Polygon_2<Kernel> const &polygon, CGAL::Segment_2<Kernel> const &segment) {
     CGAL::Point_2<Kernel> s_center = segment.source() + CGAL::Vector_2<Kernel>(segment) * 0.5;
     CGAL::Bounded_side bounded_side = CGAL::bounded_side_2(
             polygon.vertices_begin(), polygon.vertices_end(), s_center, Kernel()
@@ -120,4 +145,72 @@ bool segment_inside_polygon(CGAL::Polygon_2<Kernel> const &polygon, CGAL::Segmen
     return bounded_side == CGAL::ON_BOUNDED_SIDE || bounded_side == CGAL::ON_BOUNDARY;
 }
 
+/**
+ * Returns true, iff the segment is inside the polygon (or on its boundary).
+ */
+template<class Kernel>
+bool segment_inside_polygon(CGAL::Polygon_2<Kernel> const &polygon, CGAL::Segment_2<Kernel> const &segment) {
+    ++segment_inside_polygon_calls();
+    auto start = polygon.edges_circulator();
+    auto current_edge = start;
+    do {
+        switch (segment_edge_relation<Kernel>(current_edge, segment)) {
+            case SegmentEdgeRelation::ON_EDGE:
+                return true;
+            case SegmentEdgeRelation::CROSSING:
+                return false;
+            case SegmentEdgeRelation::NONE:
+                break;
+        }
+    } while (++current_edge != start);
+
+    return segment_center_inside_polygon(polygon, segment);
+}
+
+/**
+ * Returns true, iff the segment is inside the polygon of the grid (or on its boundary).
+ *
+ * Only the edges near the segment are tested. If the segment does not cross the boundary and starts at a polygon
+ * vertex, it is inside the polygon, iff it leaves the vertex to the inside. This avoids the point in polygon test.
+ */
+template<class Kernel>
+bool segment_inside_polygon(EdgeGrid<Kernel> const &grid, CGAL::Segment_2<Kernel> const &segment) {
+    ++segment_inside_polygon_calls();
+    auto const & polygon = grid.polygon();
+    auto start = polygon.edges_circulator();
+
+    // The edges do not need to be tested in order, since a segment on an edge cannot cross another edge
+    bool on_edge = false;
+    bool crossing = grid.find_edge(segment, [&](std::size_t i) {
+        switch (segment_edge_relation<Kernel>(start + i, segment)) {
+            case SegmentEdgeRelation::ON_EDGE:
+                on_edge = true;
+                return true;
+            case SegmentEdgeRelation::CROSSING:
+                return true;
+            case SegmentEdgeRelation::NONE:
+                return false;
+        }
+        return false;
+    });
+    if (on_edge) {
+        return true;
+    }
+    if (crossing) {
+        return false;
+    }
+
+    std::size_t source_index = grid.vertex_index(segment.source());
+    if (source_index == polygon.size()) {
+        return segment_center_inside_polygon(polygon, segment);
+    }
+
+    auto source = polygon.vertices_circulator() + source_index;
+    return counterclockwise_in_between_or_equal(
+            direction(*source, segment.target()),
+            direction(*source, *(source + 1)),
+            direction(*source, *(source - 1))
+    );
+}
+
 #endif //ANGULAR_ART_GALLERY_PROBLEM_SEGMENT_INSIDE_POLYGON_H
@@ -7,9 +7,14 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_SPLIT_POLYGON_H
 #define ANGULAR_ART_GALLERY_PROBLEM_SPLIT_POLYGON_H
 
+#include <algorithm>
+
+#include <CGAL/Kernel/global_functions_2.h>
 #include <CGAL/Polygon_2.h>
 #include <CGAL/Segment_2.h>
 
+#include "upper_bound/vertex_pool.h"
+
 
 template <class Kernel>
 using SplitContainer = std::vector<CGAL::Polygon_2<Kernel>>;
@@ -112,5 +117,98 @@ SplitResult<Kernel> split_polygon(
 }
 
 
+/**
+ * Subpolygons given by vertex ids, see split_polygon on vertex ids.
+ */
+struct SubpolygonSplit {
+    SubpolygonContainer left;
+    SubpolygonContainer right;
+};
+
+/**
+ * Same as split_right_side on polygons, for the polygon given by vertex ids. v1 and v2 are positions in polygon.
+ *
+ * \pre v1 != v2 && v1 + 1 != v2 && v1 - 1 != v2
+ */
+static SubpolygonContainer split_right_side(VertexPool const & pool, VertexIds const & polygon, std::size_t v1,
+        std::size_t v2) {
+    std::size_t n = polygon.size();
+    Segment split_segment(pool[polygon[v1]], pool[polygon[v2]]);
+    SubpolygonContainer subpolygons;
+
+    std::size_t subpolygon_begin = v1;
+    bool on_split_segment = true;
+
+    for (std::size_t current = v1, end = (v2 + 1) % n; current != end; current = (current + 1) % n) {
+        if (split_segment.has_on(pool[polygon[current]])) {
+            if (!on_split_segment) {
+                VertexIds subpolygon;
+                for (std::size_t i = subpolygon_begin; i != current; i = (i + 1) % n) {
+                    subpolygon.push_back(polygon[i]);
+                }
+                subpolygon.push_back(polygon[current]);
+                subpolygons.push_back(std::move(subpolygon));
+            }
+            subpolygon_begin = current;
+            on_split_segment = true;
+        } else {
+            on_split_segment = false;
+        }
+    }
+
+    return subpolygons;
+}
+
+/**
+ * Splits the polygon given by vertex ids by the segment between the vertices at positions v1 and v2, without copying
+ * any points. The subpolygons are returned as in split_polygon on polygons.
+ *
+ * \pre Segment lies completely inside the polygon.
+ */
+static SubpolygonSplit split_polygon(VertexPool const & pool, VertexIds const & polygon, std::size_t v1,
+        std::size_t v2) {
+    std::size_t n = polygon.size();
+    assert(v1 != v2);
+
+    if (v2 == (v1 + 1) % n) {
+        return SubpolygonSplit{{polygon}, {}};
+    } else if (v1 == (v2 + 1) % n) {
+        return SubpolygonSplit{{}, {polygon}};
+    }
+
+    auto right_side = split_right_side(pool, polygon, v1, v2);
+    auto left_side = split_right_side(pool, polygon, v2, v1);
+    return SubpolygonSplit{std::move(left_side), std::move(right_side)};
+}
+
+/**
+ * Same as normalize_polygon, for the polygon given by vertex ids.
+ *
+ * \pre Polygon is simple and has at least three vertices.
+ */
+static VertexIds normalize_polygon(VertexPool const & pool, VertexIds const & polygon) {
+    std::size_t n = polygon.size();
+    VertexIds normalized;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!CGAL::collinear(pool[polygon[(i + n - 1) % n]], pool[polygon[i]], pool[polygon[(i + 1) % n]])) {
+            normalized.push_back(polygon[i]);
+        }
+    }
+
+    // The lexicographically smallest vertex is convex in a counterclockwise oriented polygon
+    std::size_t m = normalized.size();
+    std::size_t smallest = 0;
+    for (std::size_t i = 1; i < m; ++i) {
+        if (CGAL::compare_xy(pool[normalized[i]], pool[normalized[smallest]]) == CGAL::SMALLER) {
+            smallest = i;
+        }
+    }
+    if (CGAL::right_turn(pool[normalized[(smallest + m - 1) % m]], pool[normalized[smallest]],
+            pool[normalized[(smallest + 1) % m]])) {
+        std::reverse(normalized.begin() + 1, normalized.end());
+    }
+
+    return normalized;
+}
 
 #endif //ANGULAR_ART_GALLERY_PROBLEM_SPLIT_POLYGON_H
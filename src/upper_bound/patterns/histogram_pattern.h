@@ -15,67 +15,70 @@ class HistogramPattern : public BasePattern {
 public:
     HistogramPattern(int value) : BasePattern(value) { }
 
-    bool split(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-               Visualizer &visualizer) override {
-        auto start = polygon.vertices_circulator();
-        auto current = start;
+    std::string description() const override {
+        return "Histogram pattern";
+    }
+
+protected:
+    /**
+     * The intersection points are added to the vertex pool.
+     */
+    bool concurrent_candidates() const override {
+        return false;
+    }
+
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) override {
+        long current = candidate;
+        Point const & prev = context.vertex(current - 1);
+        Point const & current_point = context.vertex(current);
+        Point const & next = context.vertex(current + 1);
 
-        do {
 #ifdef DEBUG_LOG
-            std::cout << "Current vertex: " << *current << std::endl;
+        std::cout << "Current vertex: " << current_point << std::endl;
 #endif
 
-            auto prev = current - 1;
-            auto next = current + 1;
-
-            if (!CGAL::right_turn(*prev, *current, *next)) {
-                continue;
+        if (!CGAL::right_turn(prev, current_point, next)) {
+            return false;
+        }
+
+        // Both rays start into the interior at a non-convex vertex and always hit the boundary
+        auto hit_prev = helpers::first_boundary_hit(context, current, current_point - prev);
+        auto hit_next = helpers::first_boundary_hit(context, current, current_point - next);
+        assert(hit_prev.found && hit_next.found);
+
+        // Along the edge from s to s + 1, the hit of the ray extending the next edge comes first. The hits may be the
+        // vertices of the edge.
+        long s = hit_next.vertex >= 0 ? hit_next.vertex : hit_next.edge;
+        long t = context.index(s + 1);
+        if (hit_prev.vertex >= 0 ? hit_prev.vertex == t : hit_prev.edge == s) {
+            VertexIds subpolygon_1 = context.chain(t, current - 1);
+            if (hit_prev.vertex < 0) {
+                subpolygon_1.push_back(context.add_vertex(hit_prev.point));
             }
 
-            auto polygon_intersection_prev = helpers::ray_polygon_intersection(polygon, Ray(*current, *current - *prev));
-            auto polygon_intersection_next = helpers::ray_polygon_intersection(polygon, Ray(*current, *current - *next));
-
-            if (!std::get<0>(polygon_intersection_prev) || !std::get<0>(polygon_intersection_next)) {
-                // TODO: Remove this branch, if intersection function ist complete
-                continue;
+            VertexIds subpolygon_2 = context.chain(current + 1, s);
+            if (hit_next.vertex < 0) {
+                subpolygon_2.push_back(context.add_vertex(hit_next.point));
             }
 
-            if (std::get<1>(polygon_intersection_prev) == std::get<1>(polygon_intersection_next)) {
-                remaining_polygons.pop();
-
-                auto intersecting_edge = std::get<1>(polygon_intersection_prev);
-                auto intersecting_edge_target = helpers::find_vertex_circulator(polygon, intersecting_edge->target());
-
-                Polygon subpolygon_1(intersecting_edge_target, current);
-                subpolygon_1.push_back(std::get<2>(polygon_intersection_prev));
-                subpolygon_1 = normalize_polygon(subpolygon_1);
-
-                Polygon subpolygon_2(next, intersecting_edge_target);
-                subpolygon_2.push_back(std::get<2>(polygon_intersection_next));
-                subpolygon_2 = normalize_polygon(subpolygon_2);
-
-                remaining_polygons.push(subpolygon_1);
-                remaining_polygons.push(subpolygon_2);
-
-                Segment split_seg_1(*current, std::get<2>(polygon_intersection_prev));
-                Segment split_seg_2(*current, std::get<2>(polygon_intersection_next));
-                visualizer.split_step(
-                        polygon,
-                        nullptr,
-                        &split_seg_1,
-                        &split_seg_2,
-                        this
-                );
-
-                return true;
-            }
-        } while (++current != start);
+            subpolygons.push_back(context.normalize(subpolygon_1));
+            subpolygons.push_back(context.normalize(subpolygon_2));
+
+            Segment split_seg_1(current_point, hit_prev.point);
+            Segment split_seg_2(current_point, hit_next.point);
+            visualizer.split_step(
+                    context,
+                    nullptr,
+                    &split_seg_1,
+                    &split_seg_2,
+                    this
+            );
+
+            return true;
+        }
         return false;
     }
-
-    std::string description() const override {
-        return "Histogram pattern";
-    }
 };
 
 #endif //ANGULAR_ART_GALLERY_PROBLEM_HISTOGRAM_PATTERN_H
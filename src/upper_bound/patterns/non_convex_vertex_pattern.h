@@ -7,10 +7,8 @@
 
 #include "base_pattern.h"
 #include "cgal_helpers/angle.h"
-#include "cgal_helpers/polygon_normalization.h"
 #include "helpers/convex_subpolygon_helpers.h"
 #include "upper_bound/patterns/helpers/cosine_30.h"
-#include "upper_bound/patterns/helpers/segment_inside_polygon.h"
 #include "upper_bound/patterns/helpers/split_polygon.h"
 #include "upper_bound/visualizer.h"
 
@@ -18,101 +16,93 @@ class NonConvexVertexPattern : public BasePattern {
 public:
     NonConvexVertexPattern(int value) : BasePattern(value) { }
 
-    bool split(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-               Visualizer &visualizer) override {
-        auto start = polygon.vertices_circulator();
-        auto current = start;
-
-        do {
-#ifdef DEBUG_LOG
-            std::cout << "Current vertex: " << *current << std::endl;
-#endif
+    bool failure_inherited(PolygonContext const & subpolygon, std::size_t i) const override {
+        // The pattern only looks at the polygon chain between the nearest non-convex vertices around vertex i
+        long prev = subpolygon.prev_non_convex(i);
+        long next = subpolygon.next_non_convex(i);
+        if (prev == (long)i - (long)subpolygon.size()) {
+            return false;
+        }
+        return subpolygon.chain_inherited(prev - 1, next + 1);
+    }
 
-            auto prev = current - 1;
-            auto next = current + 1;
+    bool combine_visualizations() const override {
+        return true;
+    }
 
-            if (!CGAL::right_turn(*prev, *current, *next)) {
-                continue;
-            }
+    std::string description() const override {
+        return "One non-convex vertex subpolygon pattern";
+    }
 
-            auto nearest_non_convex_prev = helpers::find_nearest_non_convex_vertices(current, true);
-            auto nearest_non_convex_next = helpers::find_nearest_non_convex_vertices(current, false);
+protected:
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) override {
+        long current = candidate;
 
-            bool only_one_non_convex = false;
-            if (nearest_non_convex_prev == prev && nearest_non_convex_next == next) {
-                continue;
-            } else if (nearest_non_convex_prev == current) {
-                assert(nearest_non_convex_next == current);
-                nearest_non_convex_prev = current + 2;
-                only_one_non_convex = true;
-            }
+#ifdef DEBUG_LOG
+        std::cout << "Current vertex: " << context.vertex(current) << std::endl;
+#endif
 
-            auto current_prev = nearest_non_convex_prev;
-            do {
-                Polygon::Vertex_const_circulator current_next;
-                if (only_one_non_convex){
-                    current_next = current_prev - 1;
-                } else {
-                    current_next = nearest_non_convex_next;
+        if (!CGAL::right_turn(context.vertex(current - 1), context.vertex(current), context.vertex(current + 1))) {
+            return false;
+        }
+
+        // The subpolygon is cut off by a diagonal between the convex chains before and after the current vertex, such
+        // that the current vertex is its only non-convex vertex
+        long nearest_non_convex_prev = context.prev_non_convex(current);
+        long nearest_non_convex_next = context.next_non_convex(current);
+
+        bool only_one_non_convex = false;
+        if (nearest_non_convex_prev == current - 1 && nearest_non_convex_next == current + 1) {
+            return false;
+        } else if (nearest_non_convex_prev == current - (long)context.size()) {
+            nearest_non_convex_prev = current + 2;
+            only_one_non_convex = true;
+        }
+
+        long first_end = only_one_non_convex ? current + (long)context.size() : current;
+        for (long first = nearest_non_convex_prev; first < first_end; ++first) {
+            long last_start = only_one_non_convex ? first - 1 : nearest_non_convex_next;
+            for (long last = last_start; last > current; --last) {
+                if (context.index(first) == context.index(last) || (first == current - 1 && last == current + 1)) {
+                    continue;
                 }
 
-                do {
-                    if (current_prev == current_next || (current_prev == prev && current_next == next)) {
-                        continue;
-                    }
-
-                    if (
-                            CGAL::left_turn(*current_next, *current_prev, *(current_prev + 1)) &&
-                            CGAL::left_turn(*(current_next - 1), *current_next, *current_prev) &&
-                            segment_inside_polygon(polygon, Segment(*current_prev, *current_next))
-                    ) {
-
-                        Polygon split_candidate;
-                        if (current_prev == current_next + 1) {
-                            split_candidate = polygon;
-                        } else {
-                            split_candidate = Polygon(current_prev, current_next + 1);
+                if (
+                        CGAL::left_turn(context.vertex(last), context.vertex(first), context.vertex(first + 1)) &&
+                        CGAL::left_turn(context.vertex(last - 1), context.vertex(last), context.vertex(first)) &&
+                        context.diagonal_inside(first, last)
+                ) {
+                    if (helpers::one_non_convex_vertex_subpolygon_coverable(context, first, last)) {
+                        auto result = context.split(first, last);
+                        assert(result.right.size() == 1);
+
+                        for (VertexIds const & subpolygon : result.left) {
+                            subpolygons.push_back(context.normalize(subpolygon));
                         }
 
-                        if (helpers::one_non_convex_vertex_subpolygon_coverable(split_candidate)) {
-                            remaining_polygons.pop();
-
-                            auto result = split_polygon(polygon, current_prev, current_next);
-                            assert(result.right.size() == 1);
-
-                            for (Polygon & subpolygon : result.left) {
-                                subpolygon = normalize_polygon(subpolygon);
-                                remaining_polygons.push(subpolygon);
-                            }
-
-                            Segment split_seg(*current_prev, *current_next);
-                            visualizer.split_step(
-                                    polygon,
-                                    &(result.right[0]),
-                                    &split_seg,
-                                    nullptr,
-                                    this
-                            );
-
-                            return true;
-                        }
+                        Segment split_seg(context.vertex(first), context.vertex(last));
+                        visualizer.split_step(
+                                context,
+                                &(result.right[0]),
+                                &split_seg,
+                                nullptr,
+                                this
+                        );
 
+                        return true;
                     }
-                } while (--current_next != current_prev && current_next != current);
-            } while (++current_prev != current);
-        } while (++current != start);
+
+                }
+            }
+        }
 
         return false;
     }
 
-    bool combine_visualizations() const override {
+    bool inherits_failures() const override {
         return true;
     }
-
-    std::string description() const override {
-        return "One non-convex vertex subpolygon pattern";
-    }
-private:
 };
 
 #endif //ANGULAR_ART_GALLERY_PROBLEM_NON_CONVEX_VERTEX_PATTERN_H
@@ -6,9 +6,7 @@
 #define ANGULAR_ART_GALLERY_PROBLEM_RADIUS_PATTERN_H
 
 #include "base_pattern.h"
-#include "cgal_helpers/polygon_normalization.h"
-#include "upper_bound/patterns/helpers/cosine_30.h"
-#include "upper_bound/patterns/helpers/segment_inside_polygon.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
 #include "upper_bound/visualizer.h"
 
 
@@ -16,69 +14,84 @@ class RadiusPattern: public BasePattern {
 public:
     RadiusPattern(int value) : BasePattern(value) {}
 
-    bool split(Polygon const &polygon, std::stack<Polygon const> &remaining_polygons,
-               Visualizer &visualizer) override {
+    bool failure_inherited(PolygonContext const & subpolygon, std::size_t i) const override {
+        // The floodlight candidates of the subpolygon are a subset of the ones of the parent polygon, as long as no
+        // new vertices were added
+        return !subpolygon.has_new_vertices() && subpolygon.chain_inherited((long)i - 1, (long)i + 1);
+    }
+
+    std::string description() const override {
+        return "Radius pattern";
+    }
+
+protected:
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
+            Visualizer & visualizer) override {
+        Polygon const & polygon = context.polygon();
         if (polygon.size() < 6) {
             return false;
         }
 
-        auto start = polygon.vertices_circulator();
-        auto current = start;
+        auto current = polygon.vertices_circulator() + candidate;
 
-        do {
 #ifdef DEBUG_LOG
-            std::cout << "Current vertex: " << *current << std::endl;
+        std::cout << "Current vertex: " << *current << std::endl;
 #endif
-            auto prev = current - 1;
-            auto next = current + 1;
+        auto prev = current - 1;
+        auto next = current + 1;
 
-            auto floodlight_candidate = next + 2;
-            do {
+        auto floodlight_candidate = next + 2;
+        do {
 #ifdef DEBUG_LOG
-                std::cout << "Current floodlight candidate: " << *floodlight_candidate << std::endl;
+            std::cout << "Current floodlight candidate: " << *floodlight_candidate << std::endl;
 #endif
-                if (
-                    Angle(*prev, *floodlight_candidate, *next).cosine() >= cosine_30(1) &&
-                    segment_inside_polygon(polygon, Segment(*floodlight_candidate, *prev)) &&
-                    segment_inside_polygon(polygon, Segment(*floodlight_candidate, *next)) &&
-                    segment_inside_polygon(polygon, Segment(*floodlight_candidate, *current))
-                ) {
-                    remaining_polygons.pop();
-                    auto result = split_polygon(polygon, floodlight_candidate, next);
-
-                    for (Polygon & subpolygon : result.left) {
-                        subpolygon = normalize_polygon(subpolygon);
-                        remaining_polygons.push(subpolygon);
-                    }
-
-                    assert(result.right.size() == 1);
-                    auto result_2 = split_polygon(result.right[0], *floodlight_candidate, *prev);
-                    assert(result_2.left.size() == 1 && (result_2.left[0].size() == 4 || result_2.left[0].size() == 3));
-                    for (Polygon & subpolygon : result_2.right) {
-                        subpolygon = normalize_polygon(subpolygon);
-                        remaining_polygons.push(subpolygon);
-                    }
-
-                    Segment split_seg_1(*floodlight_candidate, *prev);
-                    Segment split_seg_2(*floodlight_candidate, *next);
-                    visualizer.split_step(
-                            polygon,
-                            &(result_2.left[0]),
-                            &split_seg_1,
-                            &split_seg_2,
-                            this
-                    );
-
-                    return true;
-                    //visualizer.add_circle(CGAL::Circle(*))
+            long floodlight = context.vertex_index(floodlight_candidate);
+
+            // The floodlight has to lie outside the circles of the inscribed angle of 30 degree over prev-next and
+            // has to see prev, current and next. The cheap wedge test at the current vertex is done first, it
+            // rejects about half of the candidates without evaluating the angle (the wedges at prev and next and the
+            // segment tests are done by diagonal_inside).
+            if (
+                context.in_interior_angle(candidate, *floodlight_candidate) &&
+                helpers::angle_at_most_30(Angle(*prev, *floodlight_candidate, *next), 1) &&
+                context.diagonal_inside(floodlight, (long)candidate - 1) &&
+                context.diagonal_inside(floodlight, (long)candidate + 1) &&
+                context.diagonal_inside(floodlight, candidate)
+            ) {
+                auto result = context.split(floodlight, (long)candidate + 1);
+
+                for (VertexIds const & subpolygon : result.left) {
+                    subpolygons.push_back(context.normalize(subpolygon));
+                }
+
+                assert(result.right.size() == 1);
+                auto const & ids = context.vertex_ids();
+                auto result_2 = context.split(result.right[0], ids[floodlight],
+                        ids[context.index((long)candidate - 1)]);
+                assert(result_2.left.size() == 1 && (result_2.left[0].size() == 4 || result_2.left[0].size() == 3));
+                for (VertexIds const & subpolygon : result_2.right) {
+                    subpolygons.push_back(context.normalize(subpolygon));
                 }
-            } while (++floodlight_candidate != prev - 1);
-        } while (++current != start);
+
+                Segment split_seg_1(*floodlight_candidate, *prev);
+                Segment split_seg_2(*floodlight_candidate, *next);
+                visualizer.split_step(
+                        context,
+                        &(result_2.left[0]),
+                        &split_seg_1,
+                        &split_seg_2,
+                        this
+                );
+
+                return true;
+                //visualizer.add_circle(CGAL::Circle(*))
+            }
+        } while (++floodlight_candidate != prev - 1);
         return false;
     }
 
-    std::string description() const override {
-        return "Radius pattern";
+    bool inherits_failures() const override {
+        return true;
     }
 };
 
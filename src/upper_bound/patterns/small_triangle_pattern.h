@@ -7,8 +7,7 @@
 
 #include "base_pattern.h"
 #include "cgal_helpers/angle.h"
-#include "cgal_helpers/polygon_normalization.h"
-#include "upper_bound/patterns/helpers/cosine_30.h"
+#include "upper_bound/patterns/helpers/angle_predicates.h"
 #include "upper_bound/patterns/helpers/split_polygon.h"
 #include "upper_bound/visualizer.h"
 
@@ -17,74 +16,66 @@ class SmallTrianglePattern: public BasePattern {
 public:
     SmallTrianglePattern(int value) : BasePattern(value) {}
 
-    bool split(Polygon const & polygon, std::stack<Polygon const> & remaining_polygons,
+    bool combine_visualizations() const override {
+        return true;
+    }
+
+    std::string description() const override  {
+        return "Small triangle pattern";
+    }
+
+protected:
+    bool split_at(PolygonContext & context, std::size_t candidate, SubpolygonContainer & subpolygons,
             Visualizer & visualizer) override {
-        auto start = polygon.vertices_circulator();
-        auto current = start;
+        Point const & prev = context.vertex((long)candidate - 1);
+        Point const & current = context.vertex(candidate);
+        Point const & next = context.vertex((long)candidate + 1);
 
-        do {
 #ifdef DEBUG_LOG
-            std::cout << "Current vertex: " << *current << std::endl;
+        std::cout << "Current vertex: " << current << std::endl;
 #endif
 
-            if (!Angle<Kernel>(current).is_convex()) {
-                continue;
-            }
-
-            auto prev = current - 1;
-            auto next = current + 1;
+        if (!Angle<Kernel>(prev, current, next).is_convex()) {
+            return false;
+        }
 
+        auto triangle = Triangle(prev, current, next);
 
-            auto triangle = Triangle(*prev, *current, *next);
+        // If a vertex lies inside the triangle, the one nearest to the current vertex is non-convex, such that only the
+        // non-convex vertices have to be tested
+        bool triangle_empty = !context.find_non_convex_vertex(triangle.bbox(), [&](Point const & v) {
+            return triangle.has_on_bounded_side(v);
+        });
 
-            bool triangle_empty = true;
-            for (auto v = next + 1; v != prev; ++v) {
-                if (triangle.has_on_bounded_side(*v)) {
-                    triangle_empty = false;
-                    break;
-                }
-            }
+        if (!triangle_empty) {
+            return false;
+        }
 
-            if (!triangle_empty) {
-                continue;
-            }
+        if (
+                helpers::angle_at_most_30(Angle(prev, current, next), 1) ||
+                helpers::angle_at_most_30(Angle(current, next, prev), 1) ||
+                helpers::angle_at_most_30(Angle(next, prev, current), 1)
+        ) {
+            auto result = context.split((long)candidate - 1, (long)candidate + 1);
+            assert(result.right.size() == 1 && result.right[0].size() == 3);
 
-            if (
-                    Angle(*prev, *current, *next).cosine() >= cosine_30(1) ||
-                    Angle(*current, *next, *prev).cosine() >= cosine_30(1) ||
-                    Angle(*next, *prev, *current).cosine() >= cosine_30(1)
-            ) {
-                remaining_polygons.pop();
-                auto result = split_polygon(polygon, prev, next);
-                assert(result.right.size() == 1 && result.right[0].size() == 3);
-
-                for (Polygon & subpolygon : result.left) {
-                    subpolygon = normalize_polygon(subpolygon);
-                    remaining_polygons.push(subpolygon);
-                }
-
-                Segment split_seg(*prev, *next);
-                visualizer.split_step(
-                        polygon,
-                        &(result.right[0]),
-                        &split_seg,
-                        nullptr,
-                        this
-                );
-
-                return true;
+            for (VertexIds const & subpolygon : result.left) {
+                subpolygons.push_back(context.normalize(subpolygon));
             }
-        } while (++current != start);
 
-        return false;
-    }
+            Segment split_seg(prev, next);
+            visualizer.split_step(
+                    context,
+                    &(result.right[0]),
+                    &split_seg,
+                    nullptr,
+                    this
+            );
 
-    bool combine_visualizations() const override {
-        return true;
-    }
+            return true;
+        }
 
-    std::string description() const override  {
-        return "Small triangle pattern";
+        return false;
     }
 
 private:
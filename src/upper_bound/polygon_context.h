@@ -0,0 +1,431 @@
+//
+// A polygon on the solver stack, given by vertex ids into the vertex pool of the solver, together with the pattern
+// failures inherited from the polygon it was split off from and lazily built indices, which are shared by the patterns.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_POLYGON_CONTEXT_H
+#define ANGULAR_ART_GALLERY_PROBLEM_POLYGON_CONTEXT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <CGAL/Kernel/global_functions_2.h>
+
+#include "cgal_helpers/edge_grid.h"
+#include "cgal_helpers/point_grid.h"
+#include "kernel_definitions.h"
+#include "polygon_features.h"
+#include "upper_bound/patterns/helpers/segment_inside_polygon.h"
+#include "upper_bound/patterns/helpers/split_polygon.h"
+#include "vertex_pool.h"
+
+
+/**
+ * Every vertex stores a bit mask of the patterns (bit i belongs to the pattern with value i), which are known to fail
+ * for this vertex. Failures are recorded by the patterns while scanning a polygon and passed on to the subpolygons
+ * after a split, where each pattern decides whether the failure still holds (see BasePattern::failure_inherited).
+ *
+ * Subpolygons only store the ids of their vertices. The CGAL polygon is built on first use, which happens only for the
+ * polygon on top of the solver stack.
+ */
+class PolygonContext {
+public:
+    PolygonContext(VertexPool & pool, VertexIds ids)
+            : pool(&pool), ids(std::move(ids)), failures(this->ids.size(), 0),
+              inherited_edges(this->ids.size(), false), non_inherited_prefix(this->ids.size() + 1) {
+        std::iota(non_inherited_prefix.begin(), non_inherited_prefix.end(), 0);
+    }
+
+    Polygon const & polygon() const {
+        if (!polygon_) {
+            polygon_ = std::make_unique<Polygon>(pool->polygon(ids));
+        }
+        return *polygon_;
+    }
+
+    std::size_t size() const {
+        return ids.size();
+    }
+
+    VertexIds const & vertex_ids() const {
+        return ids;
+    }
+
+    /**
+     * Returns vertex i, interpreted cyclically, without building the polygon.
+     */
+    Point const & vertex(long i) const {
+        return (*pool)[ids[index(i)]];
+    }
+
+    /**
+     * Returns the index of the vertex, a circulator of polygon() points to.
+     */
+    long vertex_index(Polygon::Vertex_const_circulator v) const {
+        return v.current_iterator() - polygon().vertices_begin();
+    }
+
+    /**
+     * Returns the ids of the vertices on the polygon chain from vertex first to vertex last (both interpreted
+     * cyclically and included). If last is the vertex before first, the chain is the whole polygon.
+     */
+    VertexIds chain(long first, long last) const {
+        std::size_t length = index(last - first) + 1;
+        VertexIds result;
+        result.reserve(length);
+        for (std::size_t k = 0, i = index(first); k < length; ++k, i = (i + 1) % size()) {
+            result.push_back(ids[i]);
+        }
+        return result;
+    }
+
+    /**
+     * Adds a new vertex (e.g. an intersection point) to the vertex pool and returns its id.
+     */
+    VertexId add_vertex(Point const & point) {
+        return pool->add(point);
+    }
+
+    /**
+     * Splits the polygon by the segment between vertices i and j, see split_polygon on vertex ids.
+     */
+    SubpolygonSplit split(long i, long j) const {
+        return split_polygon(*pool, ids, index(i), index(j));
+    }
+
+    /**
+     * Splits the subpolygon by the segment between its vertices with the given ids.
+     */
+    SubpolygonSplit split(VertexIds const & subpolygon, VertexId v1, VertexId v2) const {
+        std::size_t i = std::find(subpolygon.begin(), subpolygon.end(), v1) - subpolygon.begin();
+        std::size_t j = std::find(subpolygon.begin(), subpolygon.end(), v2) - subpolygon.begin();
+        return split_polygon(*pool, subpolygon, i, j);
+    }
+
+    VertexIds normalize(VertexIds const & subpolygon) const {
+        return normalize_polygon(*pool, subpolygon);
+    }
+
+    Polygon to_polygon(VertexIds const & subpolygon) const {
+        return pool->polygon(subpolygon);
+    }
+
+    /**
+     * Spatial index of the polygon edges, built on first use and shared by all patterns.
+     */
+    EdgeGrid<Kernel> const & edge_grid() const {
+        if (!edge_grid_) {
+            edge_grid_ = std::make_unique<EdgeGrid<Kernel>>(polygon());
+        }
+        return *edge_grid_;
+    }
+
+    /**
+     * Calls f(p) for points p near the query box, until f returns true. Returns true, iff f returned true.
+     *
+     * Reported are all non-convex vertices in the box, but possibly also other vertices of this polygon or vertices of
+     * an ancestor polygon, which are not in the interior of this polygon. Thus, the triangle at a convex vertex and its
+     * neighbors contains a vertex in its interior, iff it contains a reported point in its interior.
+     *
+     * The index is built on first use and shared with the subpolygons, see inherit.
+     */
+    template <class F>
+    bool find_non_convex_vertex(CGAL::Bbox_2 const & box, F f) const {
+        for (Point const & point : new_non_convex_points) {
+            if (CGAL::do_overlap(point.bbox(), box) && f(point)) {
+                return true;
+            }
+        }
+        return non_convex_grid().find_point(box, f);
+    }
+
+    /**
+     * Builds all indices, which are otherwise built on first use, such that the context can be read by several threads
+     * concurrently.
+     */
+    void build_indices() const {
+        polygon();
+        edge_grid();
+        compute_non_convex();
+        non_convex_grid();
+    }
+
+    /**
+     * Returns true, iff the segment between vertices i and j is inside the polygon (or on its boundary). The result
+     * is cached in the vertex pool for vertices of the input polygon (see VisibilityMatrix).
+     */
+    bool diagonal_inside(long i, long j) const {
+        VertexId a = ids[index(i)];
+        VertexId b = ids[index(j)];
+        VisibilityMatrix & visibility = pool->visibility();
+        bool cached = visibility.covers(a, b);
+        if (cached) {
+            VisibilityMatrix::State state = visibility.get(a, b);
+            if (state != VisibilityMatrix::State::UNKNOWN) {
+                return state == VisibilityMatrix::State::VISIBLE;
+            }
+        }
+
+        // A segment inside the polygon leaves both vertices into their interior angles, which is much cheaper to test
+        bool inside = in_interior_angle(i, vertex(j)) && in_interior_angle(j, vertex(i))
+                && segment_inside_polygon(edge_grid(), Segment(vertex(i), vertex(j)));
+        if (cached) {
+            visibility.set(a, b, inside);
+        }
+        return inside;
+    }
+
+    /**
+     * Returns true, iff the point lies in the closed wedge of the interior angle at vertex i, i.e. the segment from
+     * vertex i to the point starts into the polygon or along one of the edges at vertex i. This is necessary for the
+     * segment to be inside the polygon.
+     */
+    bool in_interior_angle(long i, Point const & point) const {
+        Point const & prev = vertex(i - 1);
+        Point const & current = vertex(i);
+        Point const & next = vertex(i + 1);
+        bool after_next = CGAL::orientation(current, next, point) != CGAL::RIGHT_TURN;
+        bool before_prev = CGAL::orientation(current, prev, point) != CGAL::LEFT_TURN;
+        if (CGAL::left_turn(prev, current, next)) {
+            return after_next && before_prev;
+        }
+        return after_next || before_prev;
+    }
+
+    /**
+     * Returns the index of vertex i, interpreted cyclically.
+     */
+    std::size_t index(long i) const {
+        long n = size();
+        return ((i % n) + n) % n;
+    }
+
+    bool known_failure(std::size_t vertex, int pattern) const {
+        return failures[vertex] & (1u << pattern);
+    }
+
+    void record_failure(std::size_t vertex, int pattern) {
+        failures[vertex] |= (1u << pattern);
+    }
+
+    void discard_failure(std::size_t vertex, int pattern) {
+        failures[vertex] &= ~(1u << pattern);
+    }
+
+    /**
+     * Returns true, iff the edge from vertex i to vertex i + 1 is an edge of the parent polygon, too.
+     */
+    bool edge_inherited(long i) const {
+        return inherited_edges[index(i)];
+    }
+
+    /**
+     * Returns true, iff all edges on the polygon chain from vertex first to vertex last are edges of the parent polygon.
+     * The chain is interpreted counterclockwise and has to be shorter than the polygon.
+     */
+    bool chain_inherited(long first, long last) const {
+        if (last - first >= (long)size()) {
+            return false;
+        }
+        std::size_t first_idx = index(first);
+        std::size_t last_idx = index(last);
+        if (first_idx <= last_idx) {
+            return non_inherited_prefix[last_idx] - non_inherited_prefix[first_idx] == 0;
+        }
+        return non_inherited_prefix[size()] - non_inherited_prefix[first_idx] + non_inherited_prefix[last_idx] == 0;
+    }
+
+    /**
+     * Returns true, iff the polygon has vertices, which are no vertices of the parent polygon.
+     */
+    bool has_new_vertices() const {
+        return new_vertices;
+    }
+
+    /**
+     * Returns the nearest non-convex vertex after vertex i (in counterclockwise order), or i + size(), if there is
+     * none. The result is not reduced modulo the polygon size, such that it can be compared to i.
+     */
+    long next_non_convex(long i) const {
+        compute_non_convex();
+        return i + next_non_convex_distance[index(i)];
+    }
+
+    /**
+     * Returns the nearest non-convex vertex before vertex i (in counterclockwise order), or i - size(), if there is
+     * none.
+     */
+    long prev_non_convex(long i) const {
+        compute_non_convex();
+        return i - prev_non_convex_distance[index(i)];
+    }
+
+    /**
+     * Size, number of reflex vertices and orthogonality of the polygon, computed without building the polygon.
+     */
+    PolygonFeatures features() const {
+        compute_non_convex();
+        PolygonFeatures features;
+        features.size = size();
+        features.reflex_vertices = non_convex_count;
+        features.orthogonal = true;
+        for (long i = 0; i < (long)size() && features.orthogonal; ++i) {
+            Point const & p = vertex(i);
+            Point const & q = vertex(i + 1);
+            features.orthogonal = p.x() == q.x() || p.y() == q.y();
+        }
+        return features;
+    }
+
+    /**
+     * Number of splits, which lead from the input polygon to this polygon.
+     */
+    std::size_t depth() const {
+        return depth_;
+    }
+
+    /**
+     * Maps the vertices to the vertices of the parent polygon by their ids and copies their failures. The subpolygon
+     * has to consist of parent vertices in counterclockwise order, plus possibly some new vertices (e.g. on a parent
+     * edge).
+     * The copied failures have to be filtered by the patterns afterwards.
+     */
+    void inherit(PolygonContext const & parent) {
+        constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+        std::size_t n = size();
+        std::size_t m = parent.size();
+
+        std::vector<std::size_t> parent_index(n, NONE);
+        std::size_t cursor = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t k = 0; k < m; ++k) {
+                std::size_t j = (cursor + k) % m;
+                if (parent.ids[j] == ids[i]) {
+                    parent_index[i] = j;
+                    cursor = j + 1;
+                    break;
+                }
+            }
+        }
+
+        depth_ = parent.depth_ + 1;
+        new_vertices = false;
+        non_inherited_prefix.assign(n + 1, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t j = parent_index[i];
+            std::size_t j_next = parent_index[(i + 1) % n];
+            if (j == NONE) {
+                new_vertices = true;
+                failures[i] = 0;
+            } else {
+                failures[i] = parent.failures[j];
+            }
+            inherited_edges[i] = j != NONE && j_next != NONE && j_next == (j + 1) % m;
+            non_inherited_prefix[i + 1] = non_inherited_prefix[i] + (inherited_edges[i] ? 0 : 1);
+        }
+
+        // A vertex with both parent edges keeps its interior angle, only the angles at the split have to be computed
+        if (!parent.non_convex_vertices.empty()) {
+            non_convex_vertices.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                non_convex_vertices[i] = inherited_edges[i] && inherited_edges[(i + n - 1) % n]
+                        ? parent.non_convex_vertices[parent_index[i]]
+                        : !CGAL::left_turn(vertex(i - 1), vertex(i), vertex(i + 1));
+            }
+
+            // The interior angles of the parent vertices only get smaller by a split, so all non-convex vertices are
+            // in the index of the parent, except for new vertices. The index is shared, as long as the linear search of
+            // the new non-convex vertices is not more expensive than a grid query.
+            if (parent.non_convex_grid_) {
+                std::vector<Point> points = parent.new_non_convex_points;
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (parent_index[i] == NONE && non_convex_vertices[i]) {
+                        points.push_back(vertex(i));
+                    }
+                }
+                if (points.size() * points.size() <= n) {
+                    non_convex_grid_ = parent.non_convex_grid_;
+                    new_non_convex_points = std::move(points);
+                }
+            }
+        }
+    }
+
+private:
+    VertexPool * pool;
+    VertexIds ids;
+    std::vector<std::uint32_t> failures;
+    std::vector<bool> inherited_edges;
+    std::vector<std::uint32_t> non_inherited_prefix;
+    bool new_vertices = false;
+    std::size_t depth_ = 0;
+
+    mutable std::unique_ptr<Polygon> polygon_;
+    mutable std::unique_ptr<EdgeGrid<Kernel>> edge_grid_;
+    mutable std::shared_ptr<PointGrid<Kernel> const> non_convex_grid_;
+    mutable std::vector<Point> new_non_convex_points;
+
+    // Non-convex vertices, inherited from the parent where possible, and the distances to the nearest non-convex
+    // vertices, computed on first use
+    mutable std::vector<bool> non_convex_vertices;
+    mutable std::vector<long> next_non_convex_distance;
+    mutable std::vector<long> prev_non_convex_distance;
+    mutable std::size_t non_convex_count = 0;
+
+    PointGrid<Kernel> const & non_convex_grid() const {
+        if (!non_convex_grid_) {
+            compute_non_convex();
+            std::vector<Point> points;
+            points.reserve(non_convex_count);
+            for (long i = 0; i < (long)size(); ++i) {
+                if (non_convex_vertices[i]) {
+                    points.push_back(vertex(i));
+                }
+            }
+            non_convex_grid_ = std::make_shared<PointGrid<Kernel> const>(std::move(points));
+        }
+        return *non_convex_grid_;
+    }
+
+    void compute_non_convex() const {
+        if (!next_non_convex_distance.empty()) {
+            return;
+        }
+
+        long n = size();
+        if (non_convex_vertices.empty()) {
+            for (long i = 0; i < n; ++i) {
+                non_convex_vertices.push_back(!CGAL::left_turn(vertex(i - 1), vertex(i), vertex(i + 1)));
+            }
+        }
+        non_convex_count = std::count(non_convex_vertices.begin(), non_convex_vertices.end(), true);
+
+        // Two rounds, such that the distances wrap around the polygon
+        next_non_convex_distance.assign(n, n);
+        prev_non_convex_distance.assign(n, n);
+        long next = -1;
+        for (long i = 2 * n - 1; i >= 0; --i) {
+            if (next >= 0) {
+                next_non_convex_distance[i % n] = std::min(next - i, n);
+            }
+            if (non_convex_vertices[i % n]) {
+                next = i;
+            }
+        }
+        long prev = -1;
+        for (long i = 0; i < 2 * n; ++i) {
+            if (prev >= 0) {
+                prev_non_convex_distance[i % n] = std::min(i - prev, n);
+            }
+            if (non_convex_vertices[i % n]) {
+                prev = i;
+            }
+        }
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_POLYGON_CONTEXT_H
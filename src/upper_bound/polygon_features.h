@@ -0,0 +1,36 @@
+//
+// Cheap shape features of a polygon, which group the polygons of a solve into classes.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_POLYGON_FEATURES_H
+#define ANGULAR_ART_GALLERY_PROBLEM_POLYGON_FEATURES_H
+
+#include <cstddef>
+#include <string>
+
+
+/**
+ * The class of a polygon combines whether it is orthogonal, its size (4 ranges) and whether at least a third of its
+ * vertices are reflex. The patterns are ordered per class, see PatternOrder.
+ */
+struct PolygonFeatures {
+    static constexpr std::size_t CLASSES = 16;
+
+    std::size_t size = 0;
+    std::size_t reflex_vertices = 0;
+    bool orthogonal = false;
+
+    std::size_t polygon_class() const {
+        std::size_t size_class = size < 16 ? 0 : size < 64 ? 1 : size < 256 ? 2 : 3;
+        std::size_t reflex_class = 3 * reflex_vertices >= size ? 1 : 0;
+        return (orthogonal ? 8 : 0) + 2 * size_class + reflex_class;
+    }
+
+    static std::string class_description(std::size_t polygon_class) {
+        static char const * const SIZES[] = {"n<16", "16<=n<64", "64<=n<256", "n>=256"};
+        return std::string(polygon_class >= 8 ? "orthogonal" : "general") + ", " + SIZES[(polygon_class % 8) / 2] +
+                (polygon_class % 2 ? ", reflex>=n/3" : ", reflex<n/3");
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_POLYGON_FEATURES_H
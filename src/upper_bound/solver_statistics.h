@@ -0,0 +1,108 @@
+//
+// Profiling counters of the upper bound solver and its patterns.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_SOLVER_STATISTICS_H
+#define ANGULAR_ART_GALLERY_PROBLEM_SOLVER_STATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "polygon_features.h"
+
+
+/**
+ * Counters of a single pattern, which can be incremented concurrently.
+ */
+struct PatternStatistics {
+    std::atomic<std::uint64_t> calls{0};         // Calls of BasePattern::split
+    std::atomic<std::uint64_t> successes{0};     // Calls, which split the polygon
+    std::atomic<std::uint64_t> candidates{0};    // Tested split candidates
+    std::atomic<std::uint64_t> segment_tests{0}; // Evaluated segment_inside_polygon tests (without cached ones)
+    std::atomic<std::uint64_t> nanoseconds{0};   // Wall time of the split calls
+
+    void add(PatternStatistics const & other) {
+        calls.fetch_add(other.calls, std::memory_order_relaxed);
+        successes.fetch_add(other.successes, std::memory_order_relaxed);
+        candidates.fetch_add(other.candidates, std::memory_order_relaxed);
+        segment_tests.fetch_add(other.segment_tests, std::memory_order_relaxed);
+        nanoseconds.fetch_add(other.nanoseconds, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Counters of one or more solver runs. The pattern counters are indexed by the pattern value, and additionally by the
+ * class of the polygon, the pattern was applied to (see PolygonFeatures).
+ */
+struct SolverStatistics {
+    // Pattern values are limited by the failure bit masks of the polygon context
+    static constexpr std::size_t MAX_PATTERNS = 32;
+
+    std::array<PatternStatistics, MAX_PATTERNS> patterns;
+    std::array<std::array<PatternStatistics, MAX_PATTERNS>, PolygonFeatures::CLASSES> class_patterns;
+    std::atomic<std::uint64_t> polygons{0};   // Polygons taken from the stack
+    std::atomic<std::uint64_t> base_cases{0};
+    std::atomic<std::uint64_t> max_depth{0};  // Maximum number of splits, which lead to a polygon
+
+    void count_polygon(std::uint64_t depth, bool base_case) {
+        polygons.fetch_add(1, std::memory_order_relaxed);
+        if (base_case) {
+            base_cases.fetch_add(1, std::memory_order_relaxed);
+        }
+        update_max_depth(depth);
+    }
+
+    void count_pattern(std::size_t polygon_class, int pattern, PatternStatistics const & step) {
+        patterns[pattern].add(step);
+        class_patterns[polygon_class][pattern].add(step);
+    }
+
+    void add(SolverStatistics const & other) {
+        for (std::size_t i = 0; i < MAX_PATTERNS; ++i) {
+            patterns[i].add(other.patterns[i]);
+            for (std::size_t c = 0; c < PolygonFeatures::CLASSES; ++c) {
+                class_patterns[c][i].add(other.class_patterns[c][i]);
+            }
+        }
+        polygons.fetch_add(other.polygons, std::memory_order_relaxed);
+        base_cases.fetch_add(other.base_cases, std::memory_order_relaxed);
+        update_max_depth(other.max_depth);
+    }
+
+private:
+    void update_max_depth(std::uint64_t depth) {
+        std::uint64_t current = max_depth.load(std::memory_order_relaxed);
+        while (depth > current && !max_depth.compare_exchange_weak(current, depth, std::memory_order_relaxed)) { }
+    }
+};
+
+/**
+ * Course of a single solve: the features of the input polygon, the values of the applied patterns in the order of a
+ * serial run, the maximum number of splits, which lead to a polygon, the size of the unsolved subpolygon (0 if the
+ * polygon is solved) and the wall time. If the solve stopped, because no pattern matched or the time limit was reached
+ * (timed_out), the polygons, which were left unsolved, are counted in remaining_polygons.
+ *
+ * If the polygon was not solved with an adaptive pattern order, fallback traces the solve again with the fixed order.
+ */
+struct SolveTrace {
+    PolygonFeatures input;
+    std::vector<int> patterns;
+    std::size_t max_depth = 0;
+    std::size_t unsolved_size = 0;
+    std::size_t remaining_polygons = 0;
+    bool timed_out = false;
+    double seconds = 0;
+    std::shared_ptr<SolveTrace const> fallback;
+
+    /**
+     * The trace of the solve, which decided the result: the fallback solve, if any.
+     */
+    SolveTrace const & last() const {
+        return fallback ? *fallback : *this;
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_SOLVER_STATISTICS_H
@@ -0,0 +1,145 @@
+//
+// Background thread, which renders and writes the svg images of all visualizers.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_SVG_WRITER_H
+#define ANGULAR_ART_GALLERY_PROBLEM_SVG_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple-svg/simple_svg_1.0.0.hpp>
+
+
+/**
+ * An svg image, whose shapes are rendered by the writer. Shapes are shared, such that a shape drawn on several images
+ * (e.g. the covered areas) is stored only once.
+ */
+struct SvgPage {
+    std::string directory;
+    std::string path;
+    svg::Layout layout;
+    std::vector<std::shared_ptr<svg::Shape const>> shapes;
+};
+
+/**
+ * The pages are written in submission order by a single thread, such that the solvers are not blocked by rendering and
+ * file writes. The queue is bounded, a solver producing pages faster than they are written waits for free space.
+ *
+ * A write error is reported by the next call of write or flush (on any thread), or on exit, if there is none.
+ */
+class SvgWriter {
+public:
+    static constexpr std::size_t MAX_QUEUED_PAGES = 64;
+
+    /**
+     * The writer shared by all visualizers of the process. Its thread is started on first use and writes all remaining
+     * pages on exit.
+     */
+    static SvgWriter & instance() {
+        static SvgWriter writer;
+        return writer;
+    }
+
+    SvgWriter(SvgWriter const &) = delete;
+    SvgWriter & operator=(SvgWriter const &) = delete;
+
+    ~SvgWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        page_available.notify_one();
+        thread.join();
+        if (!error.empty()) {
+            std::cerr << error << std::endl;
+        }
+    }
+
+    /**
+     * \throws std::runtime_error if an earlier page could not be written
+     */
+    void write(SvgPage page) {
+        std::unique_lock<std::mutex> lock(mutex);
+        space_available.wait(lock, [this] { return pages.size() < MAX_QUEUED_PAGES || !error.empty(); });
+        throw_error();
+        pages.push_back(std::move(page));
+        lock.unlock();
+        page_available.notify_one();
+    }
+
+    /**
+     * Blocks until all submitted pages are written.
+     * \throws std::runtime_error if a page could not be written
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        space_available.wait(lock, [this] { return (pages.empty() && !writing) || !error.empty(); });
+        throw_error();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable page_available;
+    std::condition_variable space_available;
+    std::deque<SvgPage> pages;
+    bool writing = false;
+    bool stopping = false;
+    std::string error;
+    std::thread thread;
+
+    SvgWriter() : thread([this] { work(); }) { }
+
+    // Requires the lock
+    void throw_error() {
+        if (!error.empty()) {
+            std::string message = std::move(error);
+            error.clear();
+            throw std::runtime_error(message);
+        }
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            page_available.wait(lock, [this] { return !pages.empty() || stopping; });
+            if (pages.empty()) {
+                return;
+            }
+            SvgPage page = std::move(pages.front());
+            pages.pop_front();
+            writing = true;
+            lock.unlock();
+
+            std::string page_error = save(page);
+
+            lock.lock();
+            writing = false;
+            if (!page_error.empty() && error.empty()) {
+                error = page_error;
+            }
+            space_available.notify_all();
+        }
+    }
+
+    static std::string save(SvgPage const & page) {
+        std::error_code error_code;
+        std::filesystem::create_directories(page.directory, error_code);
+
+        svg::Document doc(page.path, page.layout);
+        for (auto const & shape : page.shapes) {
+            doc << *shape;
+        }
+        return doc.save() ? "" : "Couldn't write file " + page.path;
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_SVG_WRITER_H
@@ -7,23 +7,103 @@
 #ifndef ANGULAR_ART_GALLERY_PROBLEM_ALGORITHM_H
 #define ANGULAR_ART_GALLERY_PROBLEM_ALGORITHM_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stack>
+#include <stdexcept>
+
 #include "cgal_helpers/polygon_normalization.h"
 #include "kernel_definitions.h"
+#include "parallel/cancellation_token.h"
+#include "parallel/work_stealing_pool.h"
 #include "pattern_manager.h"
+#include "pattern_order.h"
+#include "polygon_context.h"
+#include "solver_statistics.h"
+#include "vertex_pool.h"
 #include "visualizer.h"
 
 
 class UpperBoundSolver {
 public:
     explicit UpperBoundSolver(Polygon const & polygon, std::vector<Pattern> const & patterns)
-            : patterns(PatternManager::get(patterns)), visualizer(polygon) {
+            : patterns(PatternManager::get(patterns)), vertex_pool(std::make_shared<VertexPool>(polygon)),
+              visualizer(polygon) {
         initialize(polygon);
     };
 
+    /**
+     * Tests the patterns in the order of the class of the current polygon instead of the fixed order. Another order
+     * leads to other subpolygons, so if the polygon is not solved (and the solve is not cancelled), it is solved again
+     * with the fixed order. Thus, the polygon is solved, iff it is solved with the fixed order (or possibly in addition).
+     * The fallback solve is counted in fallback_statistics and traced in SolveTrace::fallback.
+     * \pre order contains the same patterns as the fixed order
+     */
+    void set_pattern_order(std::shared_ptr<PatternOrder const> order) {
+        pattern_order = std::move(order);
+    }
+
+    /**
+     * Stops the solve, once the token is cancelled (e.g. by its deadline). The token is checked between the split
+     * candidates of the patterns. A stopped solve is not solved and reported as timed out in the trace.
+     */
+    void set_cancellation(std::shared_ptr<CancellationToken const> token) {
+        cancellation = std::move(token);
+    }
+
     void set_visualize(bool value) {
+        visualize = value;
         visualizer.set_visualize(value);
     }
 
+    /**
+     * Uses n threads. By default, the split candidates of the patterns are tested in parallel and the result is the
+     * same as with a single thread (see BasePattern::split).
+     * \pre KERNEL_THREAD_SAFE or n == 1
+     */
+    void set_threads(unsigned int n) {
+        if (n > 1 && !KERNEL_THREAD_SAFE) {
+            throw std::invalid_argument("Multiple threads per polygon require the Epeck kernel (AAGP_EPECK_KERNEL)");
+        }
+        thread_pool = n > 1 ? std::make_unique<WorkStealingPool>(n) : nullptr;
+    }
+
+    /**
+     * If enabled (and multiple threads are used), every subpolygon is solved in a separate task on the threads instead
+     * of testing the split candidates in parallel. The visualizations are the same as in a serial run. If the polygon
+     * is not solvable, the returned unsolved subpolygon may differ from a serial run.
+     */
+    void set_subpolygon_tasks(bool value) {
+        subpolygon_tasks = value;
+    }
+
+    /**
+     * Counters of the solve with the pattern order (see set_pattern_order), without a fallback solve. See
+     * SolverStatistics.
+     */
+    SolverStatistics const & statistics() const {
+        return statistics_;
+    }
+
+    /**
+     * Counters of the fallback solve with the fixed pattern order, if any.
+     */
+    SolverStatistics const & fallback_statistics() const {
+        return fallback_statistics_;
+    }
+
+    /**
+     * Course of the last solve, see SolveTrace. A fallback solve with the fixed pattern order is traced separately in
+     * SolveTrace::fallback.
+     */
+    SolveTrace const & trace() const {
+        return trace_;
+    }
+
     void set_output(std::string const & base_dir, std::string const & filename, std::string const & rel_dir = "") {
         output.base_dir = base_dir;
         output.filename = filename;
@@ -36,77 +116,280 @@ public:
      * \pre Polygon has at least three vertices
      */
     std::pair<bool, Polygon> solve() {
+        std::pair<bool, Polygon> result = solve_with_order(pattern_order.get(), statistics_);
+        if (!result.first && pattern_order && !trace_.timed_out) {
+            visualizer.discard();
+            SolveTrace adaptive_trace = std::move(trace_);
+            result = solve_with_order(nullptr, fallback_statistics_);
+            adaptive_trace.fallback = std::make_shared<SolveTrace const>(std::move(trace_));
+            trace_ = std::move(adaptive_trace);
+        }
+
+        if (!result.first) {
+            visualizer.draw_unsolved_polygon(result.second);
+        }
+        visualizer.close();
+        return result;
+    }
+
+private:
+    std::vector<BasePattern*> patterns;
+    std::shared_ptr<PatternOrder const> pattern_order;
+    PatternOrder const * active_order = nullptr; // Order of the current solve, if not the fixed one
+    SolverStatistics * active_statistics = nullptr; // Counters of the current solve
+    std::shared_ptr<CancellationToken const> cancellation;
+    std::atomic<bool> timed_out{false};
+    std::shared_ptr<VertexPool> vertex_pool;
+    std::unique_ptr<WorkStealingPool> thread_pool;
+    bool subpolygon_tasks = false;
+    bool visualize = false;
+    Visualizer visualizer;
+    SolverStatistics statistics_;
+    SolverStatistics fallback_statistics_;
+    SolveTrace trace_;
+
+    struct {
+        std::string base_dir;
+        std::string rel_dir;
+        std::string filename;
+    } output;
+
+    /**
+     * A subpolygon solved by a separate task. The recorded visualizations are replayed in the order of a serial run
+     * after all tasks are finished.
+     */
+    struct Task {
+        std::vector<VisualizationEvent> events;
+        std::vector<std::unique_ptr<Task>> children;
+        bool unsolved = false;
+        int pattern = -1; // Value of the pattern, which split the polygon
+        std::size_t depth = 0;
+    };
+
+    struct {
+        std::atomic<bool> found{false};
+        std::atomic<std::size_t> remaining{0}; // Tasks, which were not solved
+        std::mutex mutex;
+        Polygon polygon;
+    } unsolved;
+
+    static bool base_case(Polygon const & polygon) {
+        return polygon.is_convex() || polygon.size() < 6;
+    }
+
+    void initialize(Polygon const & polygon) {
+        if (!polygon.is_counterclockwise_oriented()) {
+            throw std::runtime_error("Polygon needs to be counterclockwise oriented");
+        }
+
+        if (!is_normalized(polygon)) {
+            throw std::runtime_error("Polygon is not normalized");
+        }
+    }
+
+    /**
+     * Solves the input polygon with the given pattern order (or the fixed order, if order is null) and returns the
+     * unsolved subpolygon, if any. The solve is counted in statistics and traced in trace_.
+     */
+    std::pair<bool, Polygon> solve_with_order(PatternOrder const * order, SolverStatistics & statistics) {
+        active_order = order;
+        active_statistics = &statistics;
+        auto start = std::chrono::steady_clock::now();
+        std::pair<bool, Polygon> result = solve_input();
+        trace_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!result.first) {
+            trace_.unsolved_size = result.second.size();
+        }
+        return result;
+    }
+
+    /**
+     * Solves the input polygon and returns the unsolved subpolygon, if any.
+     */
+    std::pair<bool, Polygon> solve_input() {
         visualizer.draw_initial_polygon();
 
+        VertexIds ids(vertex_pool->input_size());
+        std::iota(ids.begin(), ids.end(), 0);
+        PolygonContext root(*vertex_pool, std::move(ids));
+        trace_ = SolveTrace();
+        trace_.input = root.features();
+        timed_out = false;
+
+        if (thread_pool && subpolygon_tasks) {
+            return solve_tasks(std::move(root));
+        }
+
+        std::stack<PolygonContext> remaining_polygons;
+        remaining_polygons.push(std::move(root));
         while (!remaining_polygons.empty()) {
-            pattern_idx = 0; // reset patterns, start with first one
-            auto top = remaining_polygons.top();
-            assert(top.is_simple() && top.size() > 2);
+            PolygonContext top = std::move(remaining_polygons.top());
+            remaining_polygons.pop();
+            trace_.max_depth = std::max(trace_.max_depth, top.depth());
+
+            SubpolygonContainer subpolygons;
+            int pattern = -1;
+            if (!solve_step(top, subpolygons, visualizer, thread_pool.get(), pattern)) {
+                trace_.remaining_polygons = remaining_polygons.size() + 1;
+                trace_.timed_out = timed_out;
+                return std::make_pair(false, top.polygon());
+            }
+            if (pattern >= 0) {
+                trace_.patterns.push_back(pattern);
+            }
+
+            for (VertexIds & subpolygon : subpolygons) {
+                remaining_polygons.push(subpolygon_context(std::move(subpolygon), top));
+            }
+        }
+        return std::make_pair(true, Polygon());
+    }
+
+    /**
+     * Solves the base case or splits the polygon with the first matching pattern, whose value is returned in pattern
+     * (-1 for a base case). Returns false, if no pattern matches or the solve is cancelled.
+     */
+    bool solve_step(PolygonContext & top, SubpolygonContainer & subpolygons, Visualizer & step_visualizer,
+            WorkStealingPool * candidate_pool, int & pattern_value) {
+        Polygon const & polygon = top.polygon();
+        assert(polygon.is_simple() && polygon.size() > 2);
 
 #ifdef DEBUG_LOG
-                std::cout << "Current polygon: " << top << std::endl;
+        std::cout << "Current polygon: " << polygon << std::endl;
 #endif
 
-            if (base_case(top)) {
+        bool is_base_case = base_case(polygon);
+        active_statistics->count_polygon(top.depth(), is_base_case);
+
+        if (is_base_case) {
 #ifdef DEBUG_LOG
-                std::cout << "Base case" << std::endl;
+            std::cout << "Base case" << std::endl;
 #endif
 
-                remaining_polygons.pop();
-                visualizer.draw_base_case(top);
-                continue;
-            }
-
-            bool success = false;
-            while (pattern_idx < patterns.size()) {
-                BasePattern* pattern = patterns[pattern_idx++];
+            step_visualizer.draw_base_case(polygon);
+            return true;
+        }
 
+        std::size_t polygon_class = top.features().polygon_class();
+        for (BasePattern* pattern : active_order ? active_order->get(polygon_class) : patterns) {
+            if (cancellation && cancellation->cancelled()) {
+                break;
+            }
 #ifdef DEBUG_LOG
-                std::cout << "Test " << pattern->description() << std::endl;
+            std::cout << "Test " << pattern->description() << std::endl;
 #endif
 
-                if (pattern->split(top, remaining_polygons, visualizer)) {
-                    success = true;
-                    break;
-                }
+            PatternStatistics step;
+            bool success = pattern->split(top, subpolygons, step_visualizer, candidate_pool, &step,
+                    cancellation.get());
+            active_statistics->count_pattern(polygon_class, pattern->value(), step);
+            if (success) {
+                pattern_value = pattern->value();
+                return true;
             }
+        }
 
-            if (!success) {
-                visualizer.draw_unsolved_polygon(top);
-                visualizer.close();
-                return std::make_pair(false, top);
+        // After a cancellation, not all candidates were tested, such that the polygon may still be solvable
+        if (cancellation && cancellation->cancelled()) {
+            timed_out = true;
+        }
+        return false;
+    }
+
+    /**
+     * Creates the context of a subpolygon of parent, together with the pattern failures, which still hold in it.
+     */
+    PolygonContext subpolygon_context(VertexIds subpolygon, PolygonContext const & parent) const {
+        PolygonContext context(*vertex_pool, std::move(subpolygon));
+        context.inherit(parent);
+
+        for (std::size_t i = 0; i < context.size(); ++i) {
+            for (BasePattern* pattern : patterns) {
+                if (context.known_failure(i, pattern->value()) && !pattern->failure_inherited(context, i)) {
+                    context.discard_failure(i, pattern->value());
+                }
             }
         }
 
-        visualizer.close();
+        return context;
+    }
+
+    std::pair<bool, Polygon> solve_tasks(PolygonContext context) {
+        unsolved.found = false;
+        unsolved.remaining = 0;
+        Task root;
+        submit_task(std::move(context), root);
+        thread_pool->wait();
+
+        replay(root);
+        trace_.remaining_polygons = unsolved.remaining;
+        trace_.timed_out = timed_out;
+
+        if (unsolved.found) {
+            return std::make_pair(false, unsolved.polygon);
+        }
         return std::make_pair(true, Polygon());
     }
 
-private:
-    std::stack<Polygon const> remaining_polygons;
-    std::vector<BasePattern*> patterns;
-    int pattern_idx = 0;
-    Visualizer visualizer;
+    /**
+     * Solves the polygon of the context on the thread pool. The subpolygons are submitted as new tasks. No new tasks are
+     * started, once an unsolvable polygon is found.
+     */
+    void submit_task(PolygonContext context, Task & task) {
+        auto shared_context = std::make_shared<PolygonContext>(std::move(context));
+        thread_pool->submit([this, shared_context, &task] {
+            if (unsolved.found) {
+                ++unsolved.remaining;
+                return;
+            }
 
-    struct {
-        std::string base_dir;
-        std::string rel_dir;
-        std::string filename;
-    } output;
+            PolygonContext & top = *shared_context;
+            Visualizer recorder;
+            if (visualize) {
+                recorder.record(task.events);
+            }
 
-    static bool base_case(Polygon const & polygon) {
-        return polygon.is_convex() || polygon.size() < 6;
+            task.depth = top.depth();
+            SubpolygonContainer subpolygons;
+            if (!solve_step(top, subpolygons, visualize ? recorder : visualizer, nullptr, task.pattern)) {
+                std::lock_guard<std::mutex> lock(unsolved.mutex);
+                ++unsolved.remaining;
+                if (!unsolved.found) {
+                    unsolved.polygon = top.polygon();
+                    task.unsolved = true;
+                    unsolved.found = true;
+                }
+                return;
+            }
+
+            for (std::size_t i = 0; i < subpolygons.size(); ++i) {
+                task.children.push_back(std::make_unique<Task>());
+            }
+            for (std::size_t i = 0; i < subpolygons.size(); ++i) {
+                submit_task(subpolygon_context(std::move(subpolygons[i]), top), *task.children[i]);
+            }
+        });
     }
 
-    void initialize(Polygon const & polygon) {
-        if (!polygon.is_counterclockwise_oriented()) {
-            throw std::runtime_error("Polygon needs to be counterclockwise oriented");
+    /**
+     * Draws the recorded visualizations and traces the splits in the order of a serial run, where the last subpolygon
+     * is solved first, up to the unsolved polygon. Returns true, if the unsolved polygon was reached.
+     */
+    bool replay(Task const & task) {
+        visualizer.replay(task.events);
+        trace_.max_depth = std::max(trace_.max_depth, task.depth);
+        if (task.pattern >= 0) {
+            trace_.patterns.push_back(task.pattern);
         }
-
-        if (!is_normalized(polygon)) {
-            throw std::runtime_error("Polygon is not normalized");
+        if (task.unsolved) {
+            return true;
+        }
+        for (auto child = task.children.rbegin(); child != task.children.rend(); ++child) {
+            if (replay(**child)) {
+                return true;
+            }
         }
-        remaining_polygons.push(polygon);
+        return false;
     }
 };
 
@@ -0,0 +1,104 @@
+//
+// Vertices of all polygons of a single solver run, such that subpolygons can refer to them by index.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_VERTEX_POOL_H
+#define ANGULAR_ART_GALLERY_PROBLEM_VERTEX_POOL_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "kernel_definitions.h"
+#include "visibility_matrix.h"
+
+
+using VertexId = std::uint32_t;
+
+/**
+ * A subpolygon is given by the ids of its vertices in counterclockwise order.
+ */
+using VertexIds = std::vector<VertexId>;
+
+using SubpolygonContainer = std::vector<VertexIds>;
+
+/**
+ * The pool initially holds the vertices of the input polygon (vertex i has id i). Vertices, which are created during
+ * the solve (e.g. intersection points of the histogram pattern), are appended. Points are never removed and references
+ * to them stay valid.
+ *
+ * Vertices can be added by several threads, while others read. The added vertices are stored in chunks of doubling
+ * size, which are never reallocated.
+ */
+class VertexPool {
+public:
+    explicit VertexPool(Polygon const & polygon)
+            : input_points(polygon.vertices_begin(), polygon.vertices_end()), visibility_(polygon.size()) { }
+
+    /**
+     * Number of input polygon vertices, which have the ids 0, ..., input_size() - 1.
+     */
+    std::size_t input_size() const {
+        return input_points.size();
+    }
+
+    Point const & operator[](VertexId id) const {
+        if (id < input_points.size()) {
+            return input_points[id];
+        }
+        std::size_t chunk, offset;
+        locate(id - input_points.size(), chunk, offset);
+        return added_points[chunk][offset];
+    }
+
+    VertexId add(Point const & point) {
+        std::lock_guard<std::mutex> lock(add_mutex);
+        std::size_t chunk, offset;
+        locate(n_added, chunk, offset);
+        if (offset == 0) {
+            added_points[chunk].reserve(FIRST_CHUNK_SIZE << chunk);
+        }
+        added_points[chunk].push_back(point);
+        return input_points.size() + n_added++;
+    }
+
+    /**
+     * Visibility of the input polygon vertices, see VisibilityMatrix.
+     */
+    VisibilityMatrix & visibility() {
+        return visibility_;
+    }
+
+    Polygon polygon(VertexIds const & ids) const {
+        Polygon polygon;
+        for (VertexId id : ids) {
+            polygon.push_back((*this)[id]);
+        }
+        return polygon;
+    }
+
+private:
+    static constexpr std::size_t FIRST_CHUNK_SIZE = 64;
+
+    std::vector<Point> input_points;
+    std::array<std::vector<Point>, 32> added_points;
+    std::size_t n_added = 0;
+    std::mutex add_mutex;
+    VisibilityMatrix visibility_;
+
+    /**
+     * Chunk k holds the added vertices FIRST_CHUNK_SIZE * (2^k - 1), ..., FIRST_CHUNK_SIZE * (2^(k + 1) - 1) - 1.
+     */
+    static void locate(std::size_t i, std::size_t & chunk, std::size_t & offset) {
+        chunk = 0;
+        std::size_t chunk_begin = 0;
+        while (i - chunk_begin >= FIRST_CHUNK_SIZE << chunk) {
+            chunk_begin += FIRST_CHUNK_SIZE << chunk;
+            ++chunk;
+        }
+        offset = i - chunk_begin;
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_VERTEX_POOL_H
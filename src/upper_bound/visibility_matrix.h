@@ -0,0 +1,84 @@
+//
+// Cache of the mutual visibility of the input polygon vertices, shared by all subpolygons of a solver run.
+//
+
+#ifndef ANGULAR_ART_GALLERY_PROBLEM_VISIBILITY_MATRIX_H
+#define ANGULAR_ART_GALLERY_PROBLEM_VISIBILITY_MATRIX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+
+/**
+ * Two bits per unordered vertex pair (whether the visibility is known and whether the vertices see each other), stored
+ * as an upper triangular matrix. The bits are stored in atomic words, such that the matrix can be read and filled
+ * concurrently.
+ *
+ * The subpolygons are cut off along segments inside the polygon. A segment between two vertices of a subpolygon, which
+ * is inside the polygon, cannot cross such a cut twice, so it is inside the subpolygon, too. Thus, the visibility of
+ * two vertices is the same in all polygons of a solver run containing both, and it is computed only once.
+ */
+class VisibilityMatrix {
+public:
+    enum class State {
+        UNKNOWN,
+        VISIBLE,
+        INVISIBLE
+    };
+
+    /**
+     * Covers the pairs of vertices with ids less than n.
+     */
+    explicit VisibilityMatrix(std::size_t n)
+            : n(n), words(new std::atomic<std::uint64_t>[(n * (n - 1) / 2 + PAIRS_PER_WORD - 1) / PAIRS_PER_WORD]()) {
+    }
+
+    bool covers(std::uint32_t a, std::uint32_t b) const {
+        return a != b && a < n && b < n;
+    }
+
+    /**
+     * \pre covers(a, b)
+     */
+    State get(std::uint32_t a, std::uint32_t b) const {
+        std::size_t i = pair_index(a, b);
+        std::uint64_t bits = words[i / PAIRS_PER_WORD].load(std::memory_order_relaxed) >> shift(i);
+        if (!(bits & KNOWN_BIT)) {
+            return State::UNKNOWN;
+        }
+        return (bits & VISIBLE_BIT) ? State::VISIBLE : State::INVISIBLE;
+    }
+
+    /**
+     * \pre covers(a, b)
+     */
+    void set(std::uint32_t a, std::uint32_t b, bool value) {
+        std::size_t i = pair_index(a, b);
+        std::uint64_t bits = KNOWN_BIT | (value ? VISIBLE_BIT : 0);
+        words[i / PAIRS_PER_WORD].fetch_or(bits << shift(i), std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t PAIRS_PER_WORD = 32;
+    static constexpr std::uint64_t KNOWN_BIT = 1;
+    static constexpr std::uint64_t VISIBLE_BIT = 2;
+
+    std::size_t n;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words;
+
+    static std::size_t shift(std::size_t i) {
+        return 2 * (i % PAIRS_PER_WORD);
+    }
+
+    std::size_t pair_index(std::size_t a, std::size_t b) const {
+        if (a > b) {
+            std::swap(a, b);
+        }
+        // Row a starts after the rows 0, ..., a - 1 of lengths n - 1, ..., n - a
+        return a * (2 * n - a - 1) / 2 + (b - a - 1);
+    }
+};
+
+#endif //ANGULAR_ART_GALLERY_PROBLEM_VISIBILITY_MATRIX_H
@@ -6,19 +6,41 @@
 #define ANGULAR_ART_GALLERY_PROBLEM_VISUALIZER_H
 
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include <simple-svg/simple_svg_1.0.0.hpp>
 #include <upper_bound/patterns/base_pattern.h>
 
 #include "patterns/base_pattern.h"
 #include "kernel_definitions.h"
+#include "svg_writer.h"
+
+/**
+ * A base case (without pattern) or split step, recorded by a visualizer to be replayed later.
+ */
+struct VisualizationEvent {
+    Polygon polygon;
+    BasePattern const * pattern = nullptr;
+    std::optional<Polygon> covered_polygon;
+    std::optional<Segment> split_segment;
+    std::optional<Segment> split_segment_2;
+};
 
+/**
+ * Draws the steps of a solver as svg images. The images are only built, if visualization is enabled, and are rendered
+ * and written by the SvgWriter thread.
+ */
 class Visualizer {
 public:
+    /**
+     * A disabled visualizer without polygon, which costs nothing. It can only record (see record).
+     */
+    Visualizer() = default;
+
     explicit Visualizer(Polygon const & polygon, bool unsolved_polygon = false)
-        : initial_polygon_ptr(&polygon), bbox(polygon.bbox()), unsolved_polygon(unsolved_polygon) {
-        initialize_doc();
-    }
+        : unsolved_polygon(unsolved_polygon), initial_polygon_ptr(&polygon) { }
 
     void set_visualize(bool value) {
         visualize = value;
@@ -28,7 +50,32 @@ public:
         output.base_dir = base_dir;
         output.filename = filename;
         output.rel_dir = rel_dir;
-        initialize_doc();
+    }
+
+    /**
+     * Records the base cases and split steps in events instead of drawing them, such that the steps of concurrent
+     * solver tasks can be drawn in a fixed order afterwards (see replay).
+     */
+    void record(std::vector<VisualizationEvent> & events) {
+        recording = &events;
+        visualize = true;
+    }
+
+    void replay(std::vector<VisualizationEvent> const & events) {
+        for (auto const & event : events) {
+            if (!event.pattern) {
+                draw_base_case(event.polygon);
+                continue;
+            }
+            std::optional<Polygon> covered_polygon = event.covered_polygon;
+            split_step(
+                    event.polygon,
+                    covered_polygon ? &*covered_polygon : nullptr,
+                    &*event.split_segment,
+                    event.split_segment_2 ? &*event.split_segment_2 : nullptr,
+                    event.pattern
+            );
+        }
     }
 
     void draw_initial_polygon() {
@@ -58,11 +105,15 @@ public:
     }
 
     void draw_base_case(Polygon const & polygon) {
+        if (recording) {
+            recording->push_back(VisualizationEvent{polygon});
+            return;
+        }
         if (visualize) {
             if (last_pattern != UNKNOWN_PATTERN) {
                 save();
             }
-            doc << cts_polygon(*initial_polygon_ptr, svg::Stroke(1, svg::Color::Silver));
+            add(cts_polygon(*initial_polygon_ptr, svg::Stroke(1, svg::Color::Silver)));
             add_covered_areas();
             add_cts_polygon(polygon);
             add_text("Base case");
@@ -78,6 +129,14 @@ public:
             Segment const * split_segment,
             Segment const * split_segment_2,
             BasePattern const * pattern) {
+        if (recording) {
+            VisualizationEvent event{polygon, pattern};
+            if (covered_polygon) { event.covered_polygon = *covered_polygon; }
+            event.split_segment = *split_segment;
+            if (split_segment_2) { event.split_segment_2 = *split_segment_2; }
+            recording->push_back(std::move(event));
+            return;
+        }
         if (visualize) {
             int lp = last_pattern; // keep local copy of last pattern, since  last_pattern is overriden in changed
                                       // method.
@@ -87,7 +146,7 @@ public:
             }
 
             if (lp == UNKNOWN_PATTERN || pattern->value() != lp) {
-                doc << cts_polygon(*initial_polygon_ptr, svg::Stroke(1, svg::Color::Silver));
+                add(cts_polygon(*initial_polygon_ptr, svg::Stroke(1, svg::Color::Silver)));
                 current_polygon = polygon;
                 add_covered_areas();
                 add_text(pattern->description());
@@ -107,11 +166,50 @@ public:
         }
     }
 
+    /**
+     * Same as above, for a covered subpolygon given by vertex ids. The polygons are only built, if visualization is
+     * enabled.
+     */
+    void split_step(
+            PolygonContext const & context,
+            VertexIds const * covered_subpolygon,
+            Segment const * split_segment,
+            Segment const * split_segment_2,
+            BasePattern const * pattern) {
+        if (visualize) {
+            Polygon covered_polygon;
+            if (covered_subpolygon) { covered_polygon = context.to_polygon(*covered_subpolygon); }
+            split_step(
+                    context.polygon(),
+                    covered_subpolygon ? &covered_polygon : nullptr,
+                    split_segment,
+                    split_segment_2,
+                    pattern
+            );
+        }
+    }
+
     void close() {
         if (last_pattern != UNKNOWN_PATTERN) {
             save();
         }
     }
+
+    /**
+     * Removes the saved images and resets the visualizer, such that the polygon can be drawn again from the start.
+     */
+    void discard() {
+        if (counter > 0) {
+            SvgWriter::instance().flush();
+        }
+        while (counter > 0) {
+            --counter;
+            std::filesystem::remove(output_path());
+        }
+        shapes.clear();
+        covered_areas.clear();
+        last_pattern = UNKNOWN_PATTERN;
+    }
 private:
     const static int SVG_DIMENSIONS = 500;
     const static int SVG_MARGIN = 10;
@@ -119,13 +217,13 @@ private:
 
     bool visualize = false;
     bool unsolved_polygon = false;
+    std::vector<VisualizationEvent> * recording = nullptr;
 
     const int UNKNOWN_PATTERN = -1;
     int last_pattern = UNKNOWN_PATTERN;
 
     Polygon const * initial_polygon_ptr = nullptr;
     Polygon current_polygon;
-    CGAL::Bbox_2 bbox;
 
     struct {
         std::string base_dir;
@@ -133,14 +231,16 @@ private:
         std::string filename;
     } output;
     int counter = 0;
-    svg::Document doc = svg::Document("");
+    std::vector<std::shared_ptr<svg::Shape const>> shapes; // Of the current image
+    bool layout_initialized = false;
+    svg::Layout layout;
     double scale = 1;
     struct {
         double x = 0;
         double y = 0;
     } offset;
 
-    std::vector<svg::Polygon> covered_areas;
+    std::vector<std::shared_ptr<svg::Shape const>> covered_areas;
 
     std::string output_directory() const {
         if (unsolved_polygon) {
@@ -163,25 +263,33 @@ private:
         return output_directory() + "/" + filename;
     }
 
+    template <class Shape>
+    void add(Shape const & shape) {
+        shapes.push_back(std::make_shared<Shape const>(shape));
+    }
+
     void add_text(std::string const & text) {
-        doc << svg::Text(svg::Point(5, 5), text, svg::Fill(svg::Color::Black));
+        add(svg::Text(svg::Point(5, 5), text, svg::Fill(svg::Color::Black)));
     }
 
     void add_split_segment(Segment const & segment) {
-        doc << cts_segment(segment, svg::Stroke(1, svg::Color::Red));
+        add(cts_segment(segment, svg::Stroke(1, svg::Color::Red)));
     }
 
     void add_covered_areas() {
-        for (auto const & area: covered_areas) {
-            doc << area;
-        }
+        shapes.insert(shapes.end(), covered_areas.begin(), covered_areas.end());
     }
 
     void extend_covered_areas(Polygon const & polygon) {
-        covered_areas.push_back(cts_polygon(polygon, svg::Stroke(1, svg::Color::Silver), svg::Fill(svg::Color::Silver)));
+        covered_areas.push_back(std::make_shared<svg::Polygon const>(
+                cts_polygon(polygon, svg::Stroke(1, svg::Color::Silver), svg::Fill(svg::Color::Silver))));
     }
 
-    void initialize_doc() {
+    /**
+     * Computes the transformation into the image from the bounding box of the initial polygon, on the first drawing.
+     */
+    void initialize_layout() {
+        CGAL::Bbox_2 bbox = initial_polygon_ptr->bbox();
         auto canvas_size = SVG_DIMENSIONS - 2 * SVG_MARGIN;
         auto x_scale = canvas_size / (bbox.xmax() - bbox.xmin());
         auto y_scale = canvas_size / (bbox.ymax() - bbox.ymin());
@@ -191,7 +299,8 @@ private:
         offset.y = SVG_MARGIN + TEXT_OFFSET - scale * bbox.ymin();
 
         svg::Dimensions dimensions(SVG_DIMENSIONS, SVG_DIMENSIONS + TEXT_OFFSET);
-        doc = svg::Document(output_path(), svg::Layout(dimensions, svg::Layout::BottomLeft));
+        layout = svg::Layout(dimensions, svg::Layout::BottomLeft);
+        layout_initialized = true;
     }
 
     double transformX(double value) const {
@@ -203,6 +312,9 @@ private:
     }
 
     svg::Point cts_point(Point const & point) {
+        if (!layout_initialized) {
+            initialize_layout();
+        }
         return svg::Point(transformX(CGAL::to_double(point.x())), transformY(CGAL::to_double(point.y())));
     }
 
@@ -224,7 +336,7 @@ private:
             svg::Fill const & fill = svg::Fill(),
             bool highlight_vertices = true
     ) {
-        doc << cts_polygon(polygon, stroke, fill);
+        add(cts_polygon(polygon, stroke, fill));
 
         if (highlight_vertices) {
             const float MARKER_SIZE = 3;
@@ -234,11 +346,11 @@ private:
                     // marker of first vertex is squared
                     svg::Point marker = cts_point(polygon[i]);
                     marker = svg::Point(marker.x - MARKER_SIZE / 2, marker.y + MARKER_SIZE / 2);
-                    doc << svg::Rectangle(marker, MARKER_SIZE,
-                            MARKER_SIZE, marker_fill);
+                    add(svg::Rectangle(marker, MARKER_SIZE,
+                            MARKER_SIZE, marker_fill));
                 } else {
                     // all other markers are round
-                    doc << svg::Circle(cts_point(polygon[i]), MARKER_SIZE, marker_fill);
+                    add(svg::Circle(cts_point(polygon[i]), MARKER_SIZE, marker_fill));
                 }
             }
         }
@@ -248,14 +360,16 @@ private:
         return svg::Line(cts_point(segment.source()), cts_point(segment.target()), stroke);
     }
 
+    /**
+     * Hands the current image over to the writer thread and starts a new one.
+     */
     void save() {
-        std::filesystem::create_directories(output_directory());
-
-        if(!doc.save()) {
-            throw std::runtime_error("Couldn't write file " + output_path());
-        };
+        if (!layout_initialized) {
+            initialize_layout();
+        }
+        SvgWriter::instance().write(SvgPage{output_directory(), output_path(), layout, std::move(shapes)});
+        shapes.clear();
         ++counter;
-        initialize_doc();
         last_pattern = UNKNOWN_PATTERN;
     }
 };